@@ -44,11 +44,34 @@
 #include <memory>
 #include <format>
 #include <iterator>
+#include <string_view>
+#include <span>
+#include <charconv>
+#include <cstring>
+#include <concepts>
+#include <variant>
+#include <type_traits>
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <array>
+#include <algorithm>
+#include <optional>
+#include <stop_token>
+#include <initializer_list>
+#include <vector>
 
 
 #include "nlohmann/json.hpp"
 #include "siddiqsoft/SplitUri.hpp"
 #include "siddiqsoft/date-utils.hpp"
+#include "restcl_headers.hpp"
+#include "restcl_json_stream.hpp"
+#include "restcl_typed.hpp"
+#include "restcl_inplace_function.hpp"
+#if defined(RESTCL_USE_SIMDJSON)
+#include "restcl_simdjson.hpp"
+#endif
 
 
 #if __cpp_lib_format
@@ -90,6 +113,516 @@ namespace siddiqsoft
                                   {HTTPProtocolVersion::Http10, "HTTP/1.0"}});
 
 
+    /// @brief Wire names indexed by RESTMethodType; the json serialization above is retained for to_json
+    inline constexpr std::array<std::string_view, 7> RESTMethodNames {"GET", "PATCH", "POST", "PUT", "DELETE", "HEAD", "OPTIONS"};
+
+    /// @brief Wire names indexed by HTTPProtocolVersion
+    inline constexpr std::array<std::string_view, 3> HTTPProtocolVersionNames {"HTTP/2", "HTTP/1.1", "HTTP/1.0"};
+
+    constexpr std::string_view to_string_view(RESTMethodType m) { return RESTMethodNames[static_cast<size_t>(m)]; }
+
+    constexpr std::string_view to_string_view(HTTPProtocolVersion v) { return HTTPProtocolVersionNames[static_cast<size_t>(v)]; }
+
+
+    /// @brief The request line is written as prefix + uri + suffix; both parts are compile-time constants.
+    template <RESTMethodType RM>
+    inline constexpr auto request_line_prefix = [] {
+        constexpr auto                 m = to_string_view(RM);
+        std::array<char, m.size() + 1> a {};
+        for (size_t i = 0; i < m.size(); i++) a[i] = m[i];
+        a[m.size()] = ' ';
+        return a;
+    }();
+
+    template <HTTPProtocolVersion V>
+    inline constexpr auto request_line_suffix = [] {
+        constexpr auto                 v = to_string_view(V);
+        std::array<char, v.size() + 3> a {};
+        a[0] = ' ';
+        for (size_t i = 0; i < v.size(); i++) a[i + 1] = v[i];
+        a[v.size() + 1] = '\r';
+        a[v.size() + 2] = '\n';
+        return a;
+    }();
+
+    /// @brief The request line suffix for the runtime version
+    constexpr std::string_view request_line_suffix_for(HTTPProtocolVersion v)
+    {
+        switch (v) {
+            case HTTPProtocolVersion::Http11:
+                return {request_line_suffix<HTTPProtocolVersion::Http11>.data(), request_line_suffix<HTTPProtocolVersion::Http11>.size()};
+            case HTTPProtocolVersion::Http10:
+                return {request_line_suffix<HTTPProtocolVersion::Http10>.data(), request_line_suffix<HTTPProtocolVersion::Http10>.size()};
+            default: return {request_line_suffix<HTTPProtocolVersion::Http2>.data(), request_line_suffix<HTTPProtocolVersion::Http2>.size()};
+        }
+    }
+
+
+    /// @brief A contiguous char buffer which may be resized; std::string and std::vector<char> qualify.
+    /// Buffers which already have sufficient capacity are reused without allocation.
+    template <class B>
+    concept encode_buffer = requires(B& b, size_t n) {
+        { b.data() } -> std::convertible_to<char*>;
+        b.resize(n);
+    };
+
+
+    /// @brief True if the key (string or json_pointer) into the rrd refers to the element or one of its children.
+    /// The root pointer refers to every element.
+    template <class K>
+    bool rrd_key_targets(const K& key, std::string_view element)
+    {
+        if constexpr (std::is_convertible_v<const K&, std::string_view>) {
+            return std::string_view(key) == element;
+        }
+        else if constexpr (std::is_same_v<K, nlohmann::json::json_pointer>) {
+            auto path = key.to_string();
+            return path.empty() || (path.length() > element.length() && path[0] == '/' &&
+                                    std::string_view(path).substr(1, element.length()) == element &&
+                                    (path.length() == element.length() + 1 || path[element.length() + 1] == '/'));
+        }
+        else {
+            return true;
+        }
+    }
+
+
+    /// @brief Resolves the key into the rrd; the "headers" element is served by the json view of the header store.
+    /// @param rrd The request or response document
+    /// @param hdrs The header store
+    /// @param key String or json_pointer
+    template <class J, class H, class K>
+    J& rrd_at(J& rrd, H& hdrs, const K& key)
+    {
+        if constexpr (std::is_same_v<K, nlohmann::json::json_pointer>) {
+            if (auto path = key.to_string(); !path.empty() && rrd_key_targets(key, "headers")) {
+                return hdrs.json().at(nlohmann::json::json_pointer(path.substr(8)));
+            }
+        }
+        else if constexpr (std::is_convertible_v<const K&, std::string_view>) {
+            if (rrd_key_targets(key, "headers")) return hdrs.json();
+        }
+        return rrd.at(key);
+    }
+
+
+    /// @brief Set the json to null without the allocation the destructor of nlohmann::json makes to flatten a non-empty
+    /// container: the nested values are emptied first, innermost first. Nesting beyond the depth is left to the destructor.
+    /// @param j The json value
+    /// @param depth Levels of nesting emptied in place
+    inline void json_discard(nlohmann::json& j, int depth = 16)
+    {
+        if (depth > 0 && j.is_structured()) {
+            for (auto& v : j) json_discard(v, depth - 1);
+            j.clear();
+        }
+        j = nullptr;
+    }
+
+
+    /// @brief Source of the RFC 7231 Date header value. The value changes once per second so it is formatted once per second
+    /// and shared by all threads; readers copy it out of a sequence lock without blocking or allocating.
+    class http_date
+    {
+    public:
+        /// @brief Length of the IMF-fixdate "Sun, 06 Nov 1994 08:49:37 GMT"
+        static constexpr size_t LENGTH {29};
+
+        /// @brief A formatted date held by value
+        struct stamp
+        {
+            char text[32] {};
+
+            std::string_view view() const { return {text, LENGTH}; }
+        };
+
+        /// @brief The current time as IMF-fixdate
+        static stamp now()
+        {
+            using namespace std::chrono;
+
+            auto  secs  = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
+            auto& c     = shared();
+            stamp value {};
+
+            auto seq = c.sequence.load(std::memory_order_acquire);
+            if ((seq & 1) == 0) {
+                // Another thread may already have advanced the cache past our clock reading; that is as good.
+                if (c.second.load(std::memory_order_relaxed) >= secs) {
+                    uint64_t words[WORDS];
+                    for (size_t i = 0; i < WORDS; i++) words[i] = c.words[i].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    if (c.sequence.load(std::memory_order_relaxed) == seq) {
+                        std::memcpy(value.text, words, sizeof(words));
+                        return value;
+                    }
+                }
+                else if (c.sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_relaxed)) {
+                    std::atomic_thread_fence(std::memory_order_release);
+                    format(secs, value);
+                    uint64_t words[WORDS];
+                    std::memcpy(words, value.text, sizeof(words));
+                    for (size_t i = 0; i < WORDS; i++) c.words[i].store(words[i], std::memory_order_relaxed);
+                    c.second.store(secs, std::memory_order_relaxed);
+                    c.sequence.store(seq + 2, std::memory_order_release);
+                    return value;
+                }
+            }
+
+            // The cache is being refreshed by another thread; format our own rather than wait
+            format(secs, value);
+            return value;
+        }
+
+    private:
+        static constexpr size_t WORDS {sizeof(stamp::text) / sizeof(uint64_t)};
+
+        static void format(int64_t secs, stamp& dest)
+        {
+            auto s = DateUtils::RFC7231(std::chrono::system_clock::time_point(std::chrono::seconds(secs)));
+            std::memcpy(dest.text, s.data(), std::min(s.length(), LENGTH));
+        }
+
+        struct alignas(64) cache
+        {
+            std::atomic<uint64_t>                    sequence {0};
+            std::atomic<int64_t>                     second {-1};
+            std::array<std::atomic<uint64_t>, WORDS> words {};
+        };
+
+        static cache& shared()
+        {
+            static cache c {};
+            return c;
+        }
+    };
+
+
+    /// @brief Sequential writer used by the encoders once the exact size is known
+    struct wire_writer
+    {
+        char* pos {nullptr};
+
+        wire_writer& operator<<(std::string_view s)
+        {
+            if (!s.empty()) std::memcpy(pos, s.data(), s.length());
+            pos += s.length();
+            return *this;
+        }
+
+        wire_writer& operator<<(uint32_t n)
+        {
+            pos = std::to_chars(pos, pos + 10, n).ptr;
+            return *this;
+        }
+
+        /// @brief Number of characters of the decimal representation
+        static size_t digits(uint32_t n)
+        {
+            size_t d = 1;
+            while (n >= 10) {
+                n /= 10;
+                d++;
+            }
+            return d;
+        }
+    };
+
+
+    /// @brief The components of the url part "/path?query#fragment" of a uri as SplitUri splits them: the query ends at
+    /// the first '#', the path segments and the query parameters are not decoded
+    struct url_components
+    {
+        std::string_view pathPart {};
+        std::string_view queryPart {};
+        std::string_view fragment {};
+
+        static constexpr url_components split(std::string_view urlPart)
+        {
+            url_components c {};
+            auto           query    = urlPart.length();
+            auto           fragment = urlPart.length();
+
+            for (size_t i = 0; i < urlPart.length(); i++) {
+                if (urlPart[i] == '#') {
+                    fragment = i;
+                    break;
+                }
+                if (urlPart[i] == '?' && query == urlPart.length()) query = i;
+            }
+
+            c.pathPart = urlPart.substr(0, std::min(query, fragment));
+            if (query < fragment) c.queryPart = urlPart.substr(query + 1, fragment - query - 1);
+            if (fragment < urlPart.length()) c.fragment = urlPart.substr(fragment + 1);
+            return c;
+        }
+
+        /// @brief Invoke fn(segment) for each non-empty segment of the path
+        template <class F>
+        constexpr void for_each_segment(F&& fn) const
+        {
+            for (size_t b = 0; b < pathPart.length();) {
+                auto e = b;
+                while (e < pathPart.length() && pathPart[e] != '/') e++;
+                if (e > b) fn(pathPart.substr(b, e - b));
+                b = e + 1;
+            }
+        }
+
+        /// @brief Invoke fn(key, value) for each parameter of the query; the value is empty if there is no '='
+        template <class F>
+        constexpr void for_each_parameter(F&& fn) const
+        {
+            for (size_t b = 0; b < queryPart.length();) {
+                auto e  = b;
+                auto eq = std::string_view::npos;
+                for (; e < queryPart.length() && queryPart[e] != '&'; e++) {
+                    if (queryPart[e] == '=' && eq == std::string_view::npos) eq = e;
+                }
+                if (e > b) {
+                    if (eq == std::string_view::npos) fn(queryPart.substr(b, e - b), std::string_view {});
+                    else
+                        fn(queryPart.substr(b, eq - b), queryPart.substr(eq + 1, e - eq - 1));
+                }
+                b = e + 1;
+            }
+        }
+    };
+
+
+    /// @brief Replace the url part of the uri, and the path, query and fragment derived from it, without parsing the rest
+    /// of the uri
+    /// @param uri The uri; the scheme, authority and sourceUri are left as-is
+    /// @param urlPart The path, query and fragment
+    inline void assign_url_part(Uri<char>& uri, std::string_view urlPart)
+    {
+        auto c = url_components::split(urlPart);
+
+        uri.urlPart   = urlPart;
+        uri.pathPart  = c.pathPart;
+        uri.queryPart = c.queryPart;
+        uri.fragment  = c.fragment;
+        uri.path.clear();
+        c.for_each_segment([&](std::string_view s) { uri.path.emplace_back(s); });
+        uri.query.clear();
+        c.for_each_parameter([&](std::string_view k, std::string_view v) { uri.query[std::string(k)] = v; });
+    }
+
+
+    /// @brief A string literal usable as a template argument
+    template <size_t N>
+    struct fixed_string
+    {
+        char value[N] {};
+
+        consteval fixed_string(const char (&s)[N])
+        {
+            for (size_t i = 0; i < N; i++) value[i] = s[i];
+        }
+
+        constexpr std::string_view view() const { return {value, N - 1}; }
+    };
+
+
+    /// @brief The parts of an http(s) uri which a request needs: the Host header and the url part (path, query and fragment)
+    /// along with its components
+    struct static_uri
+    {
+        UriScheme                                                    scheme {UriScheme::WebHttp};
+        std::string_view                                             host {};
+        uint16_t                                                     port {0};
+        std::string_view                                             urlPart {};
+        std::string_view                                             hostHeader {};
+        std::string_view                                             source {};
+        url_components                                               components {};
+        std::span<const std::string_view>                            path {};
+        std::span<const std::pair<std::string_view, std::string_view>> query {};
+    };
+
+
+    /// @brief Splits the uri literal at compile time; a malformed uri fails to compile
+    template <fixed_string S>
+    struct static_uri_parser
+    {
+    private:
+        struct offsets
+        {
+            UriScheme scheme {UriScheme::WebHttp};
+            size_t    hostBegin {0};
+            size_t    hostLength {0};
+            uint16_t  port {0};
+            size_t    pathBegin {0};
+        };
+
+        static constexpr size_t LENGTH = sizeof(S.value) - 1;
+
+        static consteval bool startsWith(std::string_view prefix)
+        {
+            if (prefix.length() > LENGTH) return false;
+            for (size_t i = 0; i < prefix.length(); i++) {
+                if (S.value[i] != prefix[i]) return false;
+            }
+            return true;
+        }
+
+        // Index based scanning; the string_view search members are not usable on template parameter objects with all
+        // compilers.
+        static consteval offsets parse()
+        {
+            offsets o {};
+            size_t  authorityBegin {0};
+
+            if (startsWith("https://")) {
+                o.scheme       = UriScheme::WebHttps;
+                o.port         = 443;
+                authorityBegin = 8;
+            }
+            else if (startsWith("http://")) {
+                o.port         = 80;
+                authorityBegin = 7;
+            }
+            else {
+                throw "restcl: uri literal must begin with http:// or https://";
+            }
+
+            auto authorityEnd = authorityBegin;
+            while (authorityEnd < LENGTH && S.value[authorityEnd] != '/' && S.value[authorityEnd] != '?' && S.value[authorityEnd] != '#')
+                authorityEnd++;
+
+            // Skip the userinfo
+            o.hostBegin = authorityBegin;
+            for (auto i = authorityBegin; i < authorityEnd; i++) {
+                if (S.value[i] == '@') o.hostBegin = i + 1;
+            }
+
+            // The port follows the last colon (outside of an IPv6 literal)
+            auto colon = authorityEnd;
+            for (auto i = o.hostBegin; i < authorityEnd; i++) {
+                if (S.value[i] == ']') colon = authorityEnd;
+                else if (S.value[i] == ':')
+                    colon = i;
+            }
+
+            o.hostLength = colon - o.hostBegin;
+            if (o.hostLength == 0) throw "restcl: uri literal must have a host";
+            for (auto i = o.hostBegin; i < colon; i++) {
+                auto c = S.value[i];
+                if (c <= ' ' || c == '"' || c == '<' || c == '>' || c == '\\' || c == '^' || c == '`' || c == '{' || c == '|' || c == '}')
+                    throw "restcl: uri literal has an invalid character in the host";
+            }
+
+            if (colon != authorityEnd) {
+                uint32_t port {0};
+                if (authorityEnd - colon < 2 || authorityEnd - colon > 6) throw "restcl: uri literal has an invalid port";
+                for (auto i = colon + 1; i < authorityEnd; i++) {
+                    auto c = S.value[i];
+                    if (c < '0' || c > '9') throw "restcl: uri literal has an invalid port";
+                    port = port * 10 + (c - '0');
+                }
+                if (port == 0 || port > 65535) throw "restcl: uri literal has an invalid port";
+                o.port = static_cast<uint16_t>(port);
+            }
+
+            for (auto i = authorityEnd; i < LENGTH; i++) {
+                if (S.value[i] <= ' ') throw "restcl: uri literal has an invalid character in the path";
+            }
+
+            o.pathBegin = authorityEnd;
+            return o;
+        }
+
+        static constexpr offsets parts = parse();
+
+        static constexpr auto hostHeader = [] {
+            constexpr auto digits = [] {
+                size_t d = 1;
+                for (auto n = parts.port; n >= 10; n /= 10) d++;
+                return d;
+            }();
+            std::array<char, parts.hostLength + 1 + digits> a {};
+            for (size_t i = 0; i < parts.hostLength; i++) a[i] = S.value[parts.hostBegin + i];
+            a[parts.hostLength] = ':';
+            auto n              = parts.port;
+            for (size_t i = a.size(); i > parts.hostLength + 1; n /= 10) a[--i] = static_cast<char>('0' + n % 10);
+            return a;
+        }();
+
+        // The url part always starts with '/'
+        static constexpr bool needsSlash = parts.pathBegin == LENGTH || S.value[parts.pathBegin] != '/';
+
+        static constexpr auto urlPart = [] {
+            std::array<char, LENGTH - parts.pathBegin + (needsSlash ? 1 : 0)> a {};
+            size_t i = 0;
+            if (needsSlash) a[i++] = '/';
+            for (auto j = parts.pathBegin; j < LENGTH; j++) a[i++] = S.value[j];
+            return a;
+        }();
+
+        static constexpr url_components components = url_components::split({urlPart.data(), urlPart.size()});
+
+        static constexpr auto path = [] {
+            constexpr auto count = [] {
+                size_t n = 0;
+                components.for_each_segment([&](std::string_view) { n++; });
+                return n;
+            }();
+            std::array<std::string_view, count> a {};
+            size_t                              i = 0;
+            components.for_each_segment([&](std::string_view s) { a[i++] = s; });
+            return a;
+        }();
+
+        static constexpr auto query = [] {
+            constexpr auto count = [] {
+                size_t n = 0;
+                components.for_each_parameter([&](std::string_view, std::string_view) { n++; });
+                return n;
+            }();
+            std::array<std::pair<std::string_view, std::string_view>, count> a {};
+            size_t                                                           i = 0;
+            components.for_each_parameter([&](std::string_view k, std::string_view v) { a[i++] = {k, v}; });
+            return a;
+        }();
+
+    public:
+        static constexpr static_uri value {parts.scheme,
+                                           {hostHeader.data(), parts.hostLength},
+                                           parts.port,
+                                           {urlPart.data(), urlPart.size()},
+                                           {hostHeader.data(), hostHeader.size()},
+                                           S.view(),
+                                           components,
+                                           path,
+                                           query};
+    };
+
+
+    template <RESTMethodType RM, HTTPProtocolVersion HttpVer>
+    class request_prototype;
+
+
+    /// @brief Lane of the request in the asynchronous queue; the lanes share the workers by weight (see async_executor)
+    enum class request_priority : uint8_t
+    {
+        High,   // health checks, token refreshes
+        Normal, // user-facing calls
+        Low     // bulk traffic
+    };
+
+    inline constexpr size_t REQUEST_PRIORITY_LANES {3};
+
+
+    /// @brief Limits on the phases of a request; zero leaves the phase unlimited. The total runs from the start of the
+    /// request (once it leaves the queue) and combines with the deadline of the request; the earlier applies.
+    struct request_timeouts
+    {
+        std::chrono::milliseconds connect {0};   // establish the tcp connection
+        std::chrono::milliseconds tls {0};       // the TLS handshake (backends which negotiate TLS themselves)
+        std::chrono::milliseconds firstByte {0}; // from the request being sent until the response begins
+        std::chrono::milliseconds total {0};
+    };
+
+
     /// @brief Base for all RESTRequests
     class basic_request
     {
@@ -111,12 +644,37 @@ namespace siddiqsoft
         /// @brief Access the "headers", "request", "content" in the json object
         /// @param key Allows access into the json object via string or json_pointer
         /// @return Non-mutable reference to the specified element.
-        const auto& operator[](const auto& key) const { return rrd.at(key); }
+        const auto& operator[](const auto& key) const { return rrd_at(rrd, hdrs, key); }
 
         /// @brief Access the "headers", "request", "content" in the json object
         /// @param key Allows access into the json object via string or json_pointer
         /// @return Mutable reference to the specified element.
-        auto& operator[](const auto& key) { return rrd.at(key); }
+        /// @note Mutable access to the "content" discards the cached serialized content and mutable access to the "request"
+        /// discards the precomputed request line. The "headers" element is a json
+        /// view of the header store; changes are applied on the next use of headers() or the encoders.
+        auto& operator[](const auto& key)
+        {
+            if (rrd_key_targets(key, "content")) serializedContentValid = false;
+            if (rrd_key_targets(key, "request")) requestLinePrefix = requestLineSuffix = {};
+            return rrd_at(rrd, hdrs, key);
+        }
+
+        /// @brief The request headers
+        http_headers&       headers() { return hdrs; }
+        const http_headers& headers() const { return hdrs; }
+
+        /// @brief Change the protocol version of the request line
+        /// @param v The version sent on the wire
+        /// @return Self
+        basic_request& setProtocol(HTTPProtocolVersion v)
+        {
+            // Assigned in place: the version string fits the small string buffer
+            if (auto& ver = rrd["request"]["version"]; ver.is_string()) ver.get_ref<std::string&>().assign(to_string_view(v));
+            else
+                ver = to_string_view(v);
+            if (!requestLinePrefix.empty()) requestLineSuffix = request_line_suffix_for(v);
+            return *this;
+        }
 
 
         /// @brief Set the content (non-JSON)
@@ -126,39 +684,234 @@ namespace siddiqsoft
         basic_request& setContent(const std::string& ctype, const std::string& c)
         {
             if (!c.empty()) {
-                rrd["headers"]["Content-Type"]   = ctype;
-                rrd["headers"]["Content-Length"] = c.length();
-                rrd["content"]                   = c;
+                hdrs.set("Content-Type", ctype);
+                hdrs.set("Content-Length", c.length());
+                rrd["content"]         = c;
+                externalContent        = std::monostate {};
+                serializedContentValid = false;
             }
             return *this;
         }
 
-        /// @brief Set the content to json
+        /// @brief Set the content to json. The content is serialized once here and the result is re-used for the
+        /// Content-Length, encode() and the transport.
         /// @param c JSON content
         /// @return Self
         basic_request& setContent(const nlohmann::json& c)
         {
             if (!c.is_null()) {
-                rrd["content"]                   = c;
-                rrd["headers"]["Content-Length"] = c.dump().length();
+                rrd["content"]         = c;
+                serializedContent      = c.dump();
+                serializedContentValid = true;
+                externalContent        = std::monostate {};
+                hdrs.set("Content-Length", serializedContent.length());
                 // Make sure we do not override existing value
-                if (!rrd["headers"].contains("Content-Type")) rrd["headers"]["Content-Type"] = "application/json";
+                if (!hdrs.contains("Content-Type")) hdrs.set("Content-Type", "application/json");
             }
             return *this;
         }
 
+        /// @brief Set the content to the json of a struct described via RESTCL_DEFINE_TYPE_INTRUSIVE. The json text is
+        /// written directly from the members without building a json; the element rrd["content"] is null for such requests.
+        /// @param c The struct
+        /// @return Self
+        template <json_described T>
+        basic_request& setContent(const T& c)
+        {
+            serializedContent.clear();
+            append_json(serializedContent, c);
+            serializedContentValid = true;
+            rrd["content"]         = nullptr;
+            externalContent        = std::monostate {};
+            hdrs.set("Content-Length", serializedContent.length());
+            if (!hdrs.contains("Content-Type")) hdrs.set("Content-Type", "application/json");
+            return *this;
+        }
+
+        /// @brief Set the content to bytes owned by the caller. No copy is made: the memory must remain valid until the
+        /// request has been sent. The element rrd["content"] is null for such requests.
+        /// @param ctype Content-Type
+        /// @param c The borrowed content
+        /// @return Self
+        basic_request& setContent(const std::string& ctype, std::span<const std::byte> c)
+        {
+            hdrs.set("Content-Type", ctype);
+            hdrs.set("Content-Length", c.size());
+            rrd["content"]         = nullptr;
+            externalContent        = c;
+            serializedContentValid = false;
+            return *this;
+        }
+
+        /// @brief Set the content to a shared immutable buffer. The same buffer may be sent by any number of requests
+        /// without copying. The element rrd["content"] is null for such requests.
+        /// @param ctype Content-Type
+        /// @param c The shared content
+        /// @return Self
+        basic_request& setContent(const std::string& ctype, std::shared_ptr<const std::string> c)
+        {
+            hdrs.set("Content-Type", ctype);
+            hdrs.set("Content-Length", c ? c->length() : 0);
+            rrd["content"]         = nullptr;
+            externalContent        = std::move(c);
+            serializedContentValid = false;
+            return *this;
+        }
+
+
+        /// @brief Stream the json response content to the handler as it is received instead of collecting the body and
+        /// decoding it into the response. The response's content is null; the handler holds the result.
+        /// Responses which are not json (per their Content-Type) are delivered as usual.
+        /// @param handler SAX handler (see nlohmann::json_sax); use json_pointer_collector to keep selected values. The
+        /// handler is invoked on the thread performing the IO.
+        /// @return Self
+        basic_request& setContentHandler(std::shared_ptr<nlohmann::json::json_sax_t> handler)
+        {
+            contentHandler = std::move(handler);
+            return *this;
+        }
+
+        /// @brief The handler for the response content; null unless set via setContentHandler()
+        const std::shared_ptr<nlohmann::json::json_sax_t>& getContentHandler() const { return contentHandler; }
+
+        /// @brief Decode only the values at the given json pointers of a json response; the rest of the content is skipped
+        /// without being built. The response's rrd["content"] holds the values at their pointers (see json_pointer_collector).
+        /// A content handler, if set, takes precedence.
+        /// @param pointers The values to keep; clears the projection if empty
+        /// @return Self
+        basic_request& project(std::vector<nlohmann::json::json_pointer> pointers)
+        {
+            projection = pointers.empty() ? nullptr
+                                          : std::make_shared<const std::vector<nlohmann::json::json_pointer>>(std::move(pointers));
+            return *this;
+        }
+
+        /// @brief Decode only the values at the given json pointers of a json response
+        /// @param pointers The values to keep such as {"/id", "/items/0/status"}
+        /// @return Self
+        basic_request& project(std::initializer_list<std::string_view> pointers)
+        {
+            std::vector<nlohmann::json::json_pointer> ptrs {};
+            for (auto p : pointers) ptrs.emplace_back(std::string(p));
+            return project(std::move(ptrs));
+        }
+
+        /// @brief The projection of the response content; null unless set via project()
+        const std::shared_ptr<const std::vector<nlohmann::json::json_pointer>>& getProjection() const { return projection; }
+
+
+        /// @brief The lane of the request in the asynchronous queue of the client; ignored by the synchronous send()
+        basic_request& setPriority(request_priority p)
+        {
+            priority = p;
+            return *this;
+        }
+
+        request_priority getPriority() const { return priority; }
+
+
+        using deadline_clock = std::chrono::steady_clock;
+
+        /// @brief Absolute time by which the response is of use. A request whose deadline has passed before it is sent
+        /// completes with restcl_status::Timeout without touching the network; the remainder bounds the IO.
+        basic_request& setDeadline(deadline_clock::time_point t)
+        {
+            deadline = t;
+            return *this;
+        }
+
+        /// @brief Deadline relative to now
+        basic_request& setTimeout(std::chrono::milliseconds budget) { return setDeadline(deadline_clock::now() + budget); }
+
+        /// @brief The deadline; time_point::max() if there is none
+        deadline_clock::time_point getDeadline() const { return deadline; }
+
+        bool hasDeadline() const { return deadline != deadline_clock::time_point::max(); }
+
+        bool expired(deadline_clock::time_point now = deadline_clock::now()) const { return hasDeadline() && now >= deadline; }
+
+        /// @brief The budget left until the deadline (zero once it passed); milliseconds::max() if there is no deadline
+        std::chrono::milliseconds remaining(deadline_clock::time_point now = deadline_clock::now()) const
+        {
+            if (!hasDeadline()) return std::chrono::milliseconds::max();
+            return now >= deadline ? std::chrono::milliseconds {0}
+                                   : std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+        }
+
+
+        /// @brief Limits on the connect, TLS handshake, time to the first byte and the total duration of the request
+        basic_request& setTimeouts(const request_timeouts& t)
+        {
+            timeouts = t;
+            return *this;
+        }
+
+        const request_timeouts& getTimeouts() const { return timeouts; }
+
+
+        /// @brief Once a stop is requested the request is removed from the queue (if it has not started) or abandoned
+        /// mid-flight and completes with restcl_status::Cancelled. Without a stop the token costs no locks.
+        basic_request& setStopToken(std::stop_token token)
+        {
+            stopToken = std::move(token);
+            return *this;
+        }
+
+        const std::stop_token& getStopToken() const { return stopToken; }
+
+
+        /// @brief Empty the request: the uri, headers, content and everything the request references are dropped. The
+        /// transports keep a completed request in a pooled slot and move the next request into it; unlike the destructor this
+        /// does not allocate.
+        void discard()
+        {
+            json_discard(rrd);
+            hdrs.clear();
+            uri               = {};
+            requestLinePrefix = requestLineSuffix = {};
+            serializedContent.clear();
+            serializedContentValid = false;
+            externalContent        = {};
+            contentHandler.reset();
+            projection.reset();
+            priority  = request_priority::Normal;
+            deadline  = deadline_clock::time_point::max();
+            timeouts  = {};
+            stopToken = {};
+        }
+
 
         std::string getContent() const
         {
-            // Build the content to ensure we have the content-type
-            if (rrd["content"].is_object()) {
-                return rrd["content"].dump();
-            }
-            else if (rrd["content"].is_string()) {
-                return rrd["content"].get<std::string>();
+            std::string scratch;
+            return std::string(contentView(scratch));
+        }
+
+        /// @brief View of the body without copying string, borrowed or shared content
+        /// @param scratch Holds the serialized json content if the body is json
+        /// @return View of the body valid while the request and scratch are alive and unmodified
+        std::string_view getContent(std::string& scratch) const { return contentView(scratch); }
+
+
+        /// @brief Encode the request line and headers into the buffer and return the body without copying it.
+        /// The transport sends the head followed by the body (e.g. via writev/sendmsg) instead of concatenating them.
+        /// Json content modified through operator[] after setContent() is serialized into the head and the returned body
+        /// is empty.
+        /// @param head A string or vector<char>; resized to the exact size of the head
+        /// @return View of the body which remains valid while the request is alive and unmodified
+        template <encode_buffer Buffer>
+        std::span<const std::byte> encode_head_to(Buffer& head) const
+        {
+            if (!hasBodyView()) {
+                encode_to(head);
+                return {};
             }
 
-            return {};
+            auto body = bodyView();
+            auto size = encodedSize({}); // head only
+            head.resize(size);
+            write(wire_writer {head.data()}, {});
+            return std::as_bytes(std::span<const char>(body.data(), body.size()));
         }
 
 
@@ -166,22 +919,50 @@ namespace siddiqsoft
         /// @param rs String where the headers is "written-to".
         void encodeHeaders_to(std::string& rs) const
         {
-            for (auto& [k, v] : rrd["headers"].items()) {
-                if (v.is_string()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<std::string>());
-                }
-                else if (v.is_number_unsigned()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<uint64_t>());
-                }
-                else if (v.is_number_integer()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<int>());
-                }
-                else {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.dump());
-                }
-            }
+            auto offset = rs.length();
+            rs.resize(offset + encodedHeadersSize());
+            wire_writer w {rs.data() + offset};
+            writeHeaders(w);
+        }
+
+
+        /// @brief Exact number of bytes produced by encode_to()
+        size_t encoded_size() const
+        {
+            std::string scratch;
+            return encodedSize(contentView(scratch));
+        }
+
+
+        /// @brief Encode the request into the given span.
+        /// @param dest Destination; must hold at least encoded_size() bytes
+        /// @return Number of bytes written or 0 if the destination is too small
+        size_t encode_to(std::span<char> dest) const
+        {
+            std::string scratch;
+            auto        body = contentView(scratch);
+            auto        size = encodedSize(body);
+            if (dest.size() < size) return 0;
 
-            std::format_to(std::back_inserter(rs), "\r\n");
+            write(wire_writer {dest.data()}, body);
+            return size;
+        }
+
+
+        /// @brief Encode the request into the buffer which is resized to exactly the wire size.
+        /// Once the buffer has grown to the size of the request no further allocation takes place.
+        /// @param dest A string or vector<char>; re-use it across requests to avoid allocations
+        /// @return Number of bytes written
+        template <encode_buffer Buffer>
+        size_t encode_to(Buffer& dest) const
+        {
+            std::string scratch;
+            auto        body = contentView(scratch);
+            auto        size = encodedSize(body);
+
+            dest.resize(size);
+            write(wire_writer {dest.data()}, body);
+            return size;
         }
 
 
@@ -190,34 +971,78 @@ namespace siddiqsoft
         std::string encode() const
         {
             std::string rs;
-            std::string body;
-            auto&       hs = rrd.at("headers");
-            auto&       rl = rrd.at("request");
+            encode_to(rs);
+            return rs;
+        }
 
-            // Request Line
-            std::format_to(std::back_inserter(rs),
-                           "{} {} {}\r\n",
-                           rl["method"].get<std::string>(),
-                           rl["uri"].get<std::string>(),
-                           rl["version"].get<std::string>());
+    protected:
+        /// @brief True if the body is available without serialization: string, borrowed, shared or cached json content.
+        bool hasBodyView() const
+        {
+            auto& c = rrd["content"];
+            return c.is_null() || c.is_string() || serializedContentValid;
+        }
 
-            // Build the content to ensure we have the content-type
-            if (rrd["content"].is_object()) {
-                body = rrd["content"].dump();
+        /// @brief View of the body if hasBodyView()
+        std::string_view bodyView() const
+        {
+            if (auto* b = std::get_if<std::span<const std::byte>>(&externalContent); b != nullptr) {
+                return {reinterpret_cast<const char*>(b->data()), b->size()};
             }
-            else if (rrd["content"].is_string()) {
-                body = rrd["content"].get<std::string>();
+            if (auto* sb = std::get_if<std::shared_ptr<const std::string>>(&externalContent); sb != nullptr && *sb) {
+                return **sb;
             }
+            if (auto& c = rrd["content"]; c.is_string()) return c.get_ref<const std::string&>();
+            if (serializedContentValid) return serializedContent;
+            return {};
+        }
 
-            // Headers..
-            encodeHeaders_to(rs);
+        /// @brief The body as it is sent over the wire
+        /// @param scratch Holds the serialized json content; other content is referenced as-is
+        std::string_view contentView(std::string& scratch) const
+        {
+            if (hasBodyView()) return bodyView();
+            scratch = rrd["content"].dump();
+            return scratch;
+        }
 
-            // Finally the content..
-            if (!body.empty()) {
-                std::format_to(std::back_inserter(rs), "{}", body);
+        size_t encodedHeadersSize() const
+        {
+            size_t size = 2; // terminating CRLF
+            hdrs.for_each_wire([&](std::string_view part) { size += part.length(); });
+            return size;
+        }
+
+        void writeHeaders(wire_writer& w) const
+        {
+            hdrs.for_each_wire([&](std::string_view part) { w << part; });
+            w << "\r\n";
+        }
+
+        size_t encodedSize(std::string_view body) const
+        {
+            auto& rl = rrd["request"];
+            if (!requestLinePrefix.empty()) {
+                return requestLinePrefix.length() + rl["uri"].get_ref<const std::string&>().length() + requestLineSuffix.length() +
+                       encodedHeadersSize() + body.length();
             }
+            return rl["method"].get_ref<const std::string&>().length() + 1 + rl["uri"].get_ref<const std::string&>().length() + 1 +
+                   rl["version"].get_ref<const std::string&>().length() + 2 + encodedHeadersSize() + body.length();
+        }
 
-            return std::move(rs);
+        void write(wire_writer w, std::string_view body) const
+        {
+            auto& rl = rrd["request"];
+            // Request Line
+            if (!requestLinePrefix.empty())
+                w << requestLinePrefix << rl["uri"].get_ref<const std::string&>() << requestLineSuffix;
+            else
+                w << rl["method"].get_ref<const std::string&>() << " " << rl["uri"].get_ref<const std::string&>() << " "
+              << rl["version"].get_ref<const std::string&>() << "\r\n";
+            // Headers..
+            writeHeaders(w);
+            // Finally the content..
+            w << body;
         }
 
 
@@ -225,6 +1050,9 @@ namespace siddiqsoft
         friend std::ostream& operator<<(std::ostream&, const basic_request&);
         friend void          to_json(nlohmann::json&, const basic_request&);
 
+        template <RESTMethodType RM, HTTPProtocolVersion HttpVer>
+        friend class request_prototype;
+
     public:
         Uri<char, AuthorityHttp<char>> uri;
 
@@ -232,15 +1060,45 @@ namespace siddiqsoft
         nlohmann::json rrd {{"request", {{"method", nullptr}, {"uri", nullptr}, {"version", nullptr}}},
                             {"headers", nullptr},
                             {"content", nullptr}};
+
+        /// @brief The headers; rrd["headers"] is a placeholder and the json view is obtained from the store on demand
+        http_headers hdrs {};
+
+        /// @brief "METHOD " and " VERSION\r\n" of the request line from the constant tables; empty once the request line
+        /// has been modified via operator[] in which case rrd["request"] is used
+        std::string_view requestLinePrefix {};
+        std::string_view requestLineSuffix {};
+
+        /// @brief Body held outside of rrd["content"]: borrowed bytes or a shared immutable buffer
+        std::variant<std::monostate, std::span<const std::byte>, std::shared_ptr<const std::string>> externalContent {};
+
+        /// @brief The serialized json content; valid from setContent(json) until the content is modified
+        std::string serializedContent {};
+        bool        serializedContentValid {false};
+
+        /// @brief Receives the json response content as it arrives
+        std::shared_ptr<nlohmann::json::json_sax_t> contentHandler {};
+
+        /// @brief The json pointers to decode from the response content
+        std::shared_ptr<const std::vector<nlohmann::json::json_pointer>> projection {};
+
+        request_priority priority {request_priority::Normal};
+
+        deadline_clock::time_point deadline {deadline_clock::time_point::max()};
+
+        request_timeouts timeouts {};
+
+        std::stop_token stopToken {};
     };
 
     /// @brief Explicit implementation is required due to the restriction on direct instantiation of the basic_request class.
     /// @param dest The destination json
     /// @param src The basic_request class (or derived)
-    static void to_json(nlohmann::json& dest, const basic_request& src)
+    inline void to_json(nlohmann::json& dest, const basic_request& src)
     {
-        dest["uri"] = src.uri;
-        dest["rrd"] = src.rrd;
+        dest["uri"]            = src.uri;
+        dest["rrd"]            = src.rrd;
+        dest["rrd"]["headers"] = src.hdrs.json();
     }
 
 
@@ -248,6 +1106,11 @@ namespace siddiqsoft
     template <RESTMethodType RM, HTTPProtocolVersion HttpVer = HTTPProtocolVersion::Http2>
     class rest_request : public basic_request
     {
+        friend class request_prototype<RM, HttpVer>;
+
+        /// @brief Used by request_prototype which fills in the parts
+        rest_request() { }
+
     public:
         /// @brief Constructor with only endpoint as string argument
         /// @param endpoint Valid endpoint string
@@ -255,14 +1118,43 @@ namespace siddiqsoft
             : basic_request(endpoint)
         {
             // Build the request line data
-            rrd["request"] = {{"uri", uri.urlPart}, {"method", RM}, {"version", HttpVer}};
+            rrd["request"]    = {{"uri", uri.urlPart}, {"method", to_string_view(RM)}, {"version", to_string_view(HttpVer)}};
+            requestLinePrefix = {request_line_prefix<RM>.data(), request_line_prefix<RM>.size()};
+            requestLineSuffix = {request_line_suffix<HttpVer>.data(), request_line_suffix<HttpVer>.size()};
 
             // Enforce some default headers
-            auto& hs = rrd.at("headers");
-            if (!hs.contains("Date")) hs["Date"] = DateUtils::RFC7231();
-            if (!hs.contains("Accept")) hs["Accept"] = "application/json";
-            if (!hs.contains("Host")) hs["Host"] = std::format("{}:{}", uri.authority.host, uri.authority.port);
-            if (!hs.contains("Content-Length")) hs["Content-Length"] = 0;
+            if (!hdrs.contains("Date")) hdrs.set("Date", http_date::now().view());
+            if (!hdrs.contains("Accept")) hdrs.set("Accept", "application/json");
+            if (!hdrs.contains("Host")) hdrs.set("Host", std::format("{}:{}", uri.authority.host, uri.authority.port));
+            if (!hdrs.contains("Content-Length")) hdrs.set("Content-Length", 0);
+        }
+
+
+        /// @brief Constructor with a uri split at compile time (see the restcl_literals); the uri is not parsed at runtime
+        /// @param endpoint The compile-time uri
+        explicit rest_request(const static_uri& endpoint) noexcept(false)
+        {
+            uri.scheme         = endpoint.scheme;
+            uri.authority.host = endpoint.host;
+            uri.authority.port = endpoint.port;
+            uri.urlPart        = endpoint.urlPart;
+            uri.sourceUri      = endpoint.source;
+            uri.pathPart       = endpoint.components.pathPart;
+            uri.queryPart      = endpoint.components.queryPart;
+            uri.fragment       = endpoint.components.fragment;
+            uri.path.assign(endpoint.path.begin(), endpoint.path.end());
+            for (auto& [k, v] : endpoint.query) uri.query[std::string(k)] = v;
+
+            // Build the request line data
+            rrd["request"]    = {{"uri", endpoint.urlPart}, {"method", to_string_view(RM)}, {"version", to_string_view(HttpVer)}};
+            requestLinePrefix = {request_line_prefix<RM>.data(), request_line_prefix<RM>.size()};
+            requestLineSuffix = {request_line_suffix<HttpVer>.data(), request_line_suffix<HttpVer>.size()};
+
+            // The default headers
+            hdrs.set("Date", http_date::now().view());
+            hdrs.set("Accept", "application/json");
+            hdrs.set("Host", endpoint.hostHeader);
+            hdrs.set("Content-Length", 0);
         }
 
 
@@ -274,18 +1166,19 @@ namespace siddiqsoft
         {
             // Set the headers if present (we add some defaults below if not provided or missing param)
             if (h.is_object() && !h.is_null()) {
-                rrd["headers"] = h;
+                hdrs.assign(h);
             }
 
             // Build the request line data
-            rrd["request"] = {{"uri", uri.urlPart}, {"method", RM}, {"version", HttpVer}};
+            rrd["request"]    = {{"uri", uri.urlPart}, {"method", to_string_view(RM)}, {"version", to_string_view(HttpVer)}};
+            requestLinePrefix = {request_line_prefix<RM>.data(), request_line_prefix<RM>.size()};
+            requestLineSuffix = {request_line_suffix<HttpVer>.data(), request_line_suffix<HttpVer>.size()};
 
             // Enforce some default headers
-            auto& hs = rrd.at("headers");
-            if (!hs.contains("Date")) hs["Date"] = DateUtils::RFC7231();
-            if (!hs.contains("Accept")) hs["Accept"] = "application/json";
-            if (!hs.contains("Host")) hs["Host"] = std::format("{}:{}", uri.authority.host, uri.authority.port);
-            if (!hs.contains("Content-Length")) hs["Content-Length"] = 0;
+            if (!hdrs.contains("Date")) hdrs.set("Date", http_date::now().view());
+            if (!hdrs.contains("Accept")) hdrs.set("Accept", "application/json");
+            if (!hdrs.contains("Host")) hdrs.set("Host", std::format("{}:{}", uri.authority.host, uri.authority.port));
+            if (!hdrs.contains("Content-Length")) hdrs.set("Content-Length", 0);
         }
 
         /// @brief Constructor with json content
@@ -305,8 +1198,8 @@ namespace siddiqsoft
         explicit rest_request(const Uri<char>& endpoint, const nlohmann::json& h, const std::string& c) noexcept(false)
             : rest_request(endpoint, h)
         {
-            if (h.is_null() || (h.is_object() && !h.contains("Content-Type"))) rrd["headers"]["Content-Type"] = "text/plain";
-            rrd["headers"]["Content-Length"] = c.length();
+            if (!hdrs.contains("Content-Type")) hdrs.set("Content-Type", "text/plain");
+            hdrs.set("Content-Length", c.length());
             rrd["content"]                   = c;
         }
 
@@ -318,12 +1211,12 @@ namespace siddiqsoft
             : rest_request(endpoint, h)
         {
             if (c != nullptr) {
-                if (h.is_null() || (h.is_object() && !h.contains("Content-Type"))) rrd["headers"]["Content-Type"] = "text/plain";
-                rrd["headers"]["Content-Length"] = strlen(c);
+                if (!hdrs.contains("Content-Type")) hdrs.set("Content-Type", "text/plain");
+                hdrs.set("Content-Length", strlen(c));
                 rrd["content"]                   = c;
             }
             else {
-                rrd["headers"]["Content-Length"] = 0;
+                hdrs.set("Content-Length", 0);
             }
         }
     };
@@ -338,13 +1231,87 @@ namespace siddiqsoft
     using ReqHead    = rest_request<RESTMethodType::Head>;
 
 
-    static std::ostream& operator<<(std::ostream& os, const basic_request& src)
+    /// @brief A pre-built request shape used to stamp out requests which differ only in the path, a few headers and the
+    /// content. The uri, the request line and the static headers are built once; the headers are shared (copy-on-write)
+    /// by the requests and pre-encoded for the wire. Each request receives the current Date.
+    /// @code
+    /// request_prototype<RESTMethodType::Get> items {"https://api.example.com/"_Uri, {{"Authorization", "Bearer x"}}};
+    /// auto req = items.make("/items/42");
+    /// req.headers().set("X-Request-Id", id);
+    /// @endcode
+    template <RESTMethodType RM, HTTPProtocolVersion HttpVer = HTTPProtocolVersion::Http2>
+    class request_prototype
+    {
+    public:
+        /// @brief Construct the prototype
+        /// @param endpoint Fully qualified http schema uri; its path is the default for make()
+        /// @param h Optional json containing the static headers (the defaults of rest_request are added)
+        explicit request_prototype(const Uri<char>& endpoint, const nlohmann::json& h = nullptr) noexcept(false)
+            : proto(endpoint, h)
+        {
+            basic_request& p = proto;
+            p.hdrs.erase("Date");
+            shared = http_headers::share(std::move(p.hdrs));
+            p.hdrs = http_headers {};
+
+            auto& src = p.uri.sourceUri;
+            origin    = src.ends_with(p.uri.urlPart) ? src.substr(0, src.length() - p.uri.urlPart.length()) : src;
+        }
+
+        /// @brief Create a request
+        /// @param path The path and query of the request; the prototype's when empty
+        /// @return Request sharing the static headers of the prototype
+        rest_request<RM, HttpVer> make(std::string_view path = {}) const
+        {
+            rest_request<RM, HttpVer> req;
+            basic_request&            r = req;
+            const basic_request&      p = proto;
+
+            r.uri               = p.uri;
+            r.rrd               = p.rrd;
+            r.requestLinePrefix = p.requestLinePrefix;
+            r.requestLineSuffix = p.requestLineSuffix;
+            if (!path.empty()) {
+                assign_url_part(r.uri, path);
+                r.uri.sourceUri.assign(origin).append(path);
+                r.rrd["request"]["uri"] = r.uri.urlPart;
+            }
+
+            r.hdrs = http_headers(shared);
+            r.hdrs.set("Date", http_date::now().view());
+            return req;
+        }
+
+        /// @brief The static headers shared by the requests
+        const http_headers& headers() const { return *shared; }
+
+    private:
+        rest_request<RM, HttpVer>           proto;
+        std::shared_ptr<const http_headers> shared {};
+        std::string                         origin {};
+    };
+
+
+    inline std::ostream& operator<<(std::ostream& os, const basic_request& src)
     {
         os << src.encode();
         return os;
     }
 
 
+    /// @brief Parse the received json content with the backend selected at compile time: simdjson if RESTCL_USE_SIMDJSON
+    /// is defined (see the CMake option restcl_USE_SIMDJSON) otherwise nlohmann::json.
+    /// @return The json or a discarded value if the content is not valid json
+    inline nlohmann::json parse_json_content(std::string_view s)
+    {
+#if defined(RESTCL_USE_SIMDJSON)
+        return simdjson_parse(s);
+#else
+        return nlohmann::json::parse(s, nullptr, false);
+#endif
+    }
+
+
     /// @brief REST Response object
     class basic_response
     {
@@ -360,10 +1327,16 @@ namespace siddiqsoft
             NLOHMANN_DEFINE_TYPE_INTRUSIVE(response_code, code, message);
         };
 
+        /// @brief Copy constructor; the source may be read (and its content decoded) by other threads meanwhile
         basic_response(const basic_response& src) noexcept
         {
             try {
-                rrd = src.rrd;
+                std::scoped_lock l(src.cacheLock);
+                rrd      = src.rrd;
+                hdrs     = src.hdrs;
+                raw      = src.raw;
+                rawValid = src.rawValid;
+                contentPending.store(src.contentPending.load(std::memory_order_relaxed), std::memory_order_relaxed);
             }
             catch (const std::exception&) {
             }
@@ -375,6 +1348,11 @@ namespace siddiqsoft
         {
             try {
                 std::swap(rrd, src.rrd);
+                std::swap(hdrs, src.hdrs);
+                std::swap(raw, src.raw);
+                std::swap(rawValid, src.rawValid);
+                contentPending.store(src.contentPending.exchange(contentPending.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
             }
             catch (const std::exception&) {
             }
@@ -388,6 +1366,11 @@ namespace siddiqsoft
         {
             try {
                 std::swap(rrd, src.rrd);
+                std::swap(hdrs, src.hdrs);
+                std::swap(raw, src.raw);
+                std::swap(rawValid, src.rawValid);
+                contentPending.store(src.contentPending.exchange(contentPending.load(std::memory_order_relaxed), std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
             }
             catch (const std::exception&) {
             }
@@ -398,8 +1381,14 @@ namespace siddiqsoft
 
         basic_response& operator=(const basic_response& src) noexcept
         {
+            if (this == &src) return *this;
             try {
-                rrd = src.rrd;
+                std::scoped_lock l(src.cacheLock);
+                rrd      = src.rrd;
+                hdrs     = src.hdrs;
+                raw      = src.raw;
+                rawValid = src.rawValid;
+                contentPending.store(src.contentPending.load(std::memory_order_relaxed), std::memory_order_relaxed);
             }
             catch (const std::exception&) {
             }
@@ -408,30 +1397,80 @@ namespace siddiqsoft
         }
 
 
-        /// @brief Set the content of the response. An attempt is made to parse to json object
+        /// @brief Set the content of the response. The body is kept as received; if the Content-Type is json it is parsed on
+        /// the first access to resp["content"]. Use rawContent() to read the body without parsing it.
         /// @param c Content from the receive
         /// @return Self
-        basic_response& setContent(const std::string& c)
+        basic_response& setContent(std::string&& c)
         {
             if (!c.empty()) {
-                if (rrd["headers"].value("Content-Type", "").find("json") != std::string::npos) {
-                    try {
-                        rrd["content"] = nlohmann::json::parse(c);
-                        if (!rrd["headers"].contains("Content-Length")) rrd["headers"]["Content-Length"] = c.length();
-                        return *this;
-                    }
-                    catch (...) {
-                    }
-                }
-
-                // We did not decode a json; assign as-is
-                rrd["content"] = c;
-                if (!rrd["headers"].contains("Content-Length")) rrd["headers"]["Content-Length"] = c.length();
+                raw            = std::move(c);
+                rawValid       = true;
+                rrd["content"] = nullptr;
+                contentPending.store(true, std::memory_order_relaxed);
+                if (!hdrs.contains(known_header::ContentLength)) hdrs.set("Content-Length", raw.length());
             }
 
             return *this;
         }
 
+        /// @brief Set the content of the response (copy). See setContent(std::string&&)
+        /// @param c Content from the receive
+        /// @return Self
+        basic_response& setContent(const std::string& c) { return setContent(std::string(c)); }
+        basic_response& setContent(const char* c) { return setContent(std::string(c)); }
+
+        /// @brief Set the decoded content such as the projection of the received body (see basic_request::project()).
+        /// The headers are kept as received.
+        /// @param c The json content
+        /// @return Self
+        basic_response& setContent(nlohmann::json&& c)
+        {
+            rrd["content"] = std::move(c);
+            rawValid       = false;
+            contentPending.store(false, std::memory_order_relaxed);
+            raw.clear();
+            return *this;
+        }
+
+
+        /// @brief Set the status line as received; the storage of the previous values is re-used
+        basic_response& setStatusLine(std::string_view version, uint32_t status, std::string_view reason)
+        {
+            auto& r = rrd["response"];
+            assignString(r["version"], version);
+            r["status"] = status;
+            assignString(r["reason"], reason);
+            return *this;
+        }
+
+        /// @brief Return the response to the state of a new one for the next exchange; the capacity of the header block, the
+        /// body and the status line is retained
+        void reset()
+        {
+            if (!rrd.is_object() || !rrd["response"].is_object()) {
+                *this = basic_response {};
+                return;
+            }
+            setStatusLine(to_string_view(HTTPProtocolVersion::Http2), 0, {});
+            if (!rrd["content"].is_null()) rrd["content"] = nullptr;
+            hdrs.clear();
+            raw.clear();
+            rawValid = false;
+            contentPending.store(false, std::memory_order_relaxed);
+        }
+
+
+        /// @brief The body as received, without building the json document
+        /// @return View valid until the response is modified; if the content was assigned via operator[] then string content
+        /// is returned as-is and other json content is not available (empty view)
+        std::string_view rawContent() const
+        {
+            if (rawValid) return raw;
+            if (auto& c = member(rrd, "content"); c.is_string()) return c.get_ref<const std::string&>();
+            return {};
+        }
+
 
         /// @brief Check if the response was successful
         /// @return True iff there is no IOError and the StatusCode (99,400)
@@ -445,63 +1484,73 @@ namespace siddiqsoft
         /// @brief Access the "headers", "request", "content" in the json object
         /// @param key Allows access into the json object via string or json_pointer
         /// @return Non-mutable reference to the specified element.
-        const auto& operator[](const auto& key) const { return rrd.at(key); }
+        /// @note The json content is parsed and the json view of the headers built on the first access; concurrent const
+        /// access via operator[], to_json(), rawContent(), status() and the encoders from several threads is safe. The
+        /// json() view of headers() is not guarded.
+        const auto& operator[](const auto& key) const
+        {
+            if (rrd_key_targets(key, "content")) parseContent();
+            if (rrd_key_targets(key, "headers")) {
+                std::scoped_lock l(cacheLock);
+                return rrd_at(std::as_const(rrd), hdrs, key);
+            }
+            return rrd_at(std::as_const(rrd), hdrs, key);
+        }
 
 
         /// @brief Mutable access to the underlying json object
         /// @param key Allows access into the json object via string or json_pointer
         /// @return Mutable reference to the specified element.
-        auto& operator[](const auto& key) { return rrd.at(key); }
+        /// @note The "headers" element is a json view of the header store; see basic_request::operator[]. Mutable access to
+        /// the "content" releases the received body; rawContent() then reflects the json.
+        auto& operator[](const auto& key)
+        {
+            if (rrd_key_targets(key, "content")) {
+                parseContent();
+                rawValid = false;
+                raw.clear();
+            }
+            return rrd_at(rrd, hdrs, key);
+        }
 
 
-        /// @brief Encode the request to a byte stream ready to transfer to the remote server.
-        /// @return String
-        std::string encode() const
-        {
-            std::string rs;
-            std::string body;
-            auto&       hs = rrd.at("headers");
-            auto&       rl = rrd.at("response");
+        /// @brief The response headers
+        http_headers&       headers() { return hdrs; }
+        const http_headers& headers() const { return hdrs; }
 
-            // Request Line
-            std::format_to(std::back_inserter(rs),
-                           "{} {} {}\r\n",
-                           rl["version"].get<std::string>(),
-                           rl["status"].get<uint32_t>(),
-                           rl["reason"].is_null() ? "" : rl["reason"].get<std::string>());
 
-            // Build the content to ensure we have the content-type
-            if (!rrd["content"].is_null() && rrd["content"].is_object()) {
-                body = rrd["content"].dump();
-            }
-            else if (!rrd["content"].is_null() && rrd["content"].is_string()) {
-                body = rrd["content"].get<std::string>();
-            }
+        /// @brief Exact number of bytes produced by encode_to()
+        size_t encoded_size() const
+        {
+            std::string scratch;
+            return encodedSize(contentView(scratch));
+        }
 
-            // Headers..
-            for (auto& [k, v] : rrd["headers"].items()) {
-                if (v.is_string()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<std::string>());
-                }
-                else if (v.is_number_unsigned()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<uint64_t>());
-                }
-                else if (v.is_number_integer()) {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.get<int>());
-                }
-                else {
-                    std::format_to(std::back_inserter(rs), "{}: {}\r\n", k, v.dump());
-                }
-            }
 
-            std::format_to(std::back_inserter(rs), "\r\n");
+        /// @brief Encode the response into the buffer which is resized to exactly the wire size.
+        /// Once the buffer has grown to the size of the response no further allocation takes place.
+        /// @param dest A string or vector<char>; re-use it across responses to avoid allocations
+        /// @return Number of bytes written
+        template <encode_buffer Buffer>
+        size_t encode_to(Buffer& dest) const
+        {
+            std::string scratch;
+            auto        body = contentView(scratch);
+            auto        size = encodedSize(body);
 
-            // Finally the content..
-            if (!body.empty()) {
-                std::format_to(std::back_inserter(rs), "{}", body);
-            }
+            dest.resize(size);
+            write(wire_writer {dest.data()}, body);
+            return size;
+        }
 
-            return std::move(rs);
+
+        /// @brief Encode the response to a byte stream
+        /// @return String
+        std::string encode() const
+        {
+            std::string rs;
+            encode_to(rs);
+            return rs;
         }
 
 
@@ -511,16 +1560,150 @@ namespace siddiqsoft
         /// The response contains:
         /// resp["response"]["status"] or WinHTTP error code
         /// resp["response"]["reason"] or WinHTTP error code message string
-        response_code status() const { return {rrd["response"].value<unsigned>("status", 0), rrd["response"].value("reason", "")}; }
+        response_code status() const
+        {
+            auto& r = member(rrd, "response");
+            return {r.value<unsigned>("status", 0), r.value("reason", "")};
+        }
 
     public:
-        NLOHMANN_DEFINE_TYPE_INTRUSIVE(basic_response, rrd);
+        friend void to_json(nlohmann::json& dest, const basic_response& src)
+        {
+            src.parseContent();
+            std::scoped_lock l(src.cacheLock);
+            dest["rrd"]            = src.rrd;
+            dest["rrd"]["headers"] = src.hdrs.json();
+        }
+
+        friend void from_json(const nlohmann::json& src, basic_response& dest)
+        {
+            src.at("rrd").get_to(dest.rrd);
+            dest.hdrs.assign(dest.rrd["headers"]);
+            dest.rrd["headers"]  = nullptr;
+            dest.rawValid = false;
+            dest.contentPending.store(false, std::memory_order_relaxed);
+            dest.raw.clear();
+        }
+
         friend std::ostream& operator<<(std::ostream&, const basic_response&);
+        friend class content_receiver;
 
     protected:
-        nlohmann::json rrd {{"response", {{"version", HTTPProtocolVersion::Http2}, {"status", 0}, {"reason", ""}}},
-                            {"headers", nullptr},
-                            {"content", nullptr}};
+        /// @brief The element of the object for const readers; absent elements read as null instead of being inserted
+        static const nlohmann::json& member(const nlohmann::json& j, std::string_view key)
+        {
+            static const nlohmann::json absent {};
+            if (!j.is_object()) return absent;
+            auto it = j.find(key);
+            return it != j.end() ? *it : absent;
+        }
+
+        static void assignString(nlohmann::json& dest, std::string_view v)
+        {
+            if (dest.is_string()) dest.get_ref<std::string&>().assign(v);
+            else
+                dest = v;
+        }
+
+        /// @brief Decode the received body into rrd["content"]: json if the Content-Type is json and the body parses, otherwise
+        /// the string as received. The first of several concurrent const readers decodes while the others wait for it.
+        void parseContent() const
+        {
+            if (!contentPending.load(std::memory_order_acquire)) return;
+
+            std::scoped_lock l(cacheLock);
+            if (!contentPending.load(std::memory_order_relaxed)) return;
+
+            if (hdrs.value(known_header::ContentType).find("json") != std::string_view::npos) {
+                if (auto doc = parse_json_content(raw); !doc.is_discarded()) {
+                    rrd["content"] = std::move(doc);
+                    contentPending.store(false, std::memory_order_release);
+                    return;
+                }
+            }
+
+            // We did not decode a json; assign as-is
+            rrd["content"] = raw;
+            contentPending.store(false, std::memory_order_release);
+        }
+
+        /// @brief The body as it is sent over the wire; the received body is used as-is
+        std::string_view contentView(std::string& scratch) const
+        {
+            if (rawValid) return raw;
+            auto& c = member(rrd, "content");
+            if (c.is_string()) return c.get_ref<const std::string&>();
+            if (!c.is_null()) {
+                scratch = c.dump();
+                return scratch;
+            }
+            return {};
+        }
+
+        /// @brief The status line fields; the reason phrase may be absent
+        std::string_view versionView() const
+        {
+            auto& v = member(member(rrd, "response"), "version");
+            return v.is_string() ? std::string_view(v.get_ref<const std::string&>()) : std::string_view {};
+        }
+
+        std::string_view reasonView() const
+        {
+            auto& r = member(member(rrd, "response"), "reason");
+            return r.is_string() ? std::string_view(r.get_ref<const std::string&>()) : std::string_view {};
+        }
+
+        size_t encodedSize(std::string_view body) const
+        {
+            size_t size = versionView().length() + 1 + wire_writer::digits(status().code) + 1 +
+                          reasonView().length() + 2;
+            hdrs.for_each([&](std::string_view k, std::string_view v) { size += k.length() + 2 + v.length() + 2; });
+            return size + 2 + body.length();
+        }
+
+        void write(wire_writer w, std::string_view body) const
+        {
+            // Response Line
+            w << versionView() << " " << status().code << " " << reasonView() << "\r\n";
+            // Headers..
+            hdrs.for_each([&](std::string_view k, std::string_view v) { w << k << ": " << v << "\r\n"; });
+            w << "\r\n";
+            // Finally the content..
+            w << body;
+        }
+
+    protected:
+        /// @brief Mutable as the received content is decoded on the first (possibly const) access
+        mutable nlohmann::json rrd {{"response", {{"version", to_string_view(HTTPProtocolVersion::Http2)}, {"status", 0}, {"reason", ""}}},
+                                    {"headers", nullptr},
+                                    {"content", nullptr}};
+
+        /// @brief The headers; rrd["headers"] is a placeholder and the json view is obtained from the store on demand
+        http_headers hdrs {};
+
+        /// @brief The body as received; rrd["content"] is decoded from it on first access while contentPending
+        std::string  raw {};
+        bool         rawValid {false};
+
+        /// @brief The caches built by const readers, the decode of rrd["content"] and the json view of the headers, are
+        /// built under cacheLock; contentPending is written by parseContent() under the lock and by the non-const members
+        mutable std::atomic_bool contentPending {false};
+        mutable std::mutex       cacheLock {};
+    };
+
+
+    /// @brief Status codes of the responses produced by the library itself rather than by the server or the transport.
+    /// The range lies above the HTTP status codes and apart from the transport errors (WinHTTP 12xxx, EpollRESTClient
+    /// 20000 + errno).
+    enum class restcl_status : int
+    {
+        Exception = 19000, // the backend threw; the reason holds the message
+        Shutdown  = 19001, // the executor was destroyed before the request was sent
+        QueueFull = 19002, // rejected by the bounded queue of the executor (overflow_policy::Reject)
+        Dropped   = 19003, // removed from the bounded queue to admit a newer request (overflow_policy::DropOldest)
+        Timeout   = 19004, // the deadline of the request passed before it was sent
+        Cancelled = 19005, // a stop was requested via the stop_token of the request
+        Retryable = 19006  // a kept-alive connection closed before the response; not resent as the method is not idempotent
     };
 
 
@@ -533,6 +1716,8 @@ namespace siddiqsoft
 
         rest_response(const int code, const std::string& message) { setStatus(code, message); }
 
+        rest_response(restcl_status code, const std::string& message) { setStatus(static_cast<int>(code), message); }
+
 
         /// @brief Construct a response object based on the given transport error
         /// @param err Specifies the transport error.
@@ -545,9 +1730,91 @@ namespace siddiqsoft
     };
 
 
+    /// @brief Receives the response body on behalf of the transports. Depending on the request the json content is fed to
+    /// its content handler, decoded into the projection or, as is the case for any other content, collected as-is.
+    class content_receiver
+    {
+    public:
+        /// @brief Note the content handler and the projection of the request
+        void expect(const basic_request& req)
+        {
+            handler    = req.getContentHandler();
+            projection = req.getProjection();
+        }
+
+        /// @brief Choose how the body is received once the response headers are known
+        void begin(const http_headers& h)
+        {
+            if (!handler && !projection) return;
+            if (h.value(known_header::ContentType).find("json") == std::string_view::npos) return;
+
+            if (handler) {
+                stream.emplace(*handler);
+            }
+            else {
+                collector = std::make_unique<json_pointer_collector>(*projection);
+                stream.emplace(*collector);
+            }
+        }
+
+        /// @brief A piece of the body; streamed content is dropped once the handler has stopped the parse
+        void append(std::string_view part)
+        {
+            if (stream) stream->feed(part);
+            else
+                body.append(part);
+        }
+
+        /// @brief Forget the previous response before the response object is re-used; the body buffer handed to it is
+        /// taken back so that its capacity serves the next body
+        void reset(basic_response& resp)
+        {
+            std::swap(body, resp.raw);
+            body.clear();
+            handler.reset();
+            projection.reset();
+            collector.reset();
+            stream.reset();
+        }
+
+        /// @brief Complete the body and move it (or the projection) into the response
+        void end(basic_response& resp)
+        {
+            if (!stream) {
+                resp.setContent(std::move(body));
+                return;
+            }
+
+            stream->finish();
+            if (collector) resp.setContent(std::move(collector->result()));
+        }
+
+    private:
+        std::string                                                      body {};
+        std::shared_ptr<nlohmann::json::json_sax_t>                      handler {};
+        std::shared_ptr<const std::vector<nlohmann::json::json_pointer>> projection {};
+        std::unique_ptr<json_pointer_collector>                          collector {};
+        std::optional<json_stream_parser<>>                              stream {};
+    };
+
+
     /// @brief The function or lambda must accept const basic_request& and const basic_response&
     using basic_callbacktype = std::function<void(const basic_request&, const basic_response&)>;
 
+    /// @brief Callback which takes ownership of the request and the response; neither is copied to be kept.
+    /// Move-only; a callable of up to 64 bytes is held without allocating.
+    using basic_movecallbacktype = inplace_function<void(basic_request&&, basic_response&&)>;
+
+
+    /// @brief The response of the typed send along with its json content decoded into T
+    template <class T>
+    struct typed_response
+    {
+        basic_response   response;
+        std::optional<T> content {}; // empty if the content is not json or does not decode into T
+        std::string      error {};
+    };
+
 
     /// @brief Base class for the rest client
     class basic_restclient
@@ -555,6 +1822,12 @@ namespace siddiqsoft
     public:
         std::string  UserAgent {"siddiqsoft.restcl/1.6.0"};
         std::wstring UserAgentW {L"siddiqsoft.restcl/1.6.0"};
+        /// @brief When false the Date header is removed before the request is sent. Servers do not need it and RFC 7231
+        /// section 7.1.1.2 advises clients to omit it unless it is useful to the server.
+        bool SendDate {true};
+        /// @brief When set, requests with a deadline carry the remaining budget in milliseconds in this header (for
+        /// instance `Request-Timeout`) so that the server may give up on work the client no longer waits for.
+        std::string DeadlineHeader {};
 
     public:
         /// @brief Synchronous implementation of the IO
@@ -571,11 +1844,93 @@ namespace siddiqsoft
         /// @param req Request
         /// @param callback function that accepts const basic_restrequst& and const basic_response&
         virtual void send(basic_request&&, basic_callbacktype&&) = 0;
+
+        /// @brief Support for async callback which receives the response (and the request) by move so that it may be kept or
+        /// handed on without a copy
+        /// @param req Request
+        /// @param callback Callable accepting (basic_request&&, basic_response&&) or (basic_response&&)
+        template <class F>
+            requires(std::invocable<F, basic_request&&, basic_response&&> &&
+                     !std::invocable<F, const basic_request&, const basic_response&>) ||
+                    std::invocable<F, basic_response&&>
+        void send(basic_request&& req, F&& callback)
+        {
+            if constexpr (std::invocable<F, basic_response&&>) {
+                dispatch(std::move(req),
+                         basic_movecallbacktype {[cb = std::forward<F>(callback)](basic_request&&, basic_response&& resp) mutable {
+                             cb(std::move(resp));
+                         }});
+            }
+            else {
+                dispatch(std::move(req), basic_movecallbacktype {std::forward<F>(callback)});
+            }
+        }
+
+
+        /// @brief Asynchronous send which may be cancelled: once a stop is requested via the token the request is removed
+        /// from the queue or abandoned mid-flight and the callback receives restcl_status::Cancelled. Fanning a request out
+        /// with one stop_source allows the first response to cut the others short.
+        /// @param req Request
+        /// @param token Sets the stop token of the request
+        /// @param callback Any of the callbacks accepted by the other asynchronous send() overloads
+        template <class F>
+            requires std::invocable<F, basic_request&&, basic_response&&> || std::invocable<F, basic_response&&> ||
+                     std::invocable<F, const basic_request&, const basic_response&>
+        void send(basic_request&& req, std::stop_token token, F&& callback)
+        {
+            req.setStopToken(std::move(token));
+            send(std::move(req), std::forward<F>(callback));
+        }
+
+
+        /// @brief Synchronous send which decodes the json content directly into T as it is received (see struct_decoder)
+        /// instead of building the json. The response has no content. Replaces the request's content handler.
+        /// @tparam T A struct described via RESTCL_DEFINE_TYPE_INTRUSIVE (or any type supported by struct_decoder)
+        /// @param req Request
+        /// @return The response and the decoded content
+        template <class T>
+        [[nodiscard]] typed_response<T> send(basic_request& req)
+        {
+            auto decoder = std::make_shared<struct_decoder<T>>();
+            req.setContentHandler(decoder);
+            typed_response<T> r {send(req)};
+            req.setContentHandler(nullptr);
+
+            if (decoder->valid()) r.content = std::move(decoder->result());
+            else
+                r.error = decoder->error().empty() ? "no json content" : decoder->error();
+            return r;
+        }
+
+        /// @brief Asynchronous send which decodes the json content directly into T. See send<T>(basic_request&)
+        /// @param req Request
+        /// @param callback Invoked with the request, the response and the decoded content (empty if it did not decode)
+        template <class T>
+        void send(basic_request&& req, std::function<void(const basic_request&, const basic_response&, const std::optional<T>&)>&& callback)
+        {
+            auto decoder = std::make_shared<struct_decoder<T>>();
+            req.setContentHandler(decoder);
+            send(std::move(req), basic_callbacktype {[decoder, cb = std::move(callback)](const basic_request& rq, const basic_response& rs) {
+                     std::optional<T> content {};
+                     if (decoder->valid()) content = std::move(decoder->result());
+                     cb(rq, rs, content);
+                 }});
+        }
+
+    protected:
+        /// @brief Queue the request; the callback is given the request and the response by move
+        virtual void dispatch(basic_request&&, basic_movecallbacktype&&) = 0;
+
+        /// @brief Write the remaining budget of the request into the DeadlineHeader (if both are set)
+        void stampDeadline(basic_request& req) const
+        {
+            if (!DeadlineHeader.empty() && req.hasDeadline()) req.headers().set(DeadlineHeader, req.remaining().count());
+        }
     };
 
 
     /// @brief Serializer to ostream for RESResponseType
-    static std::ostream& operator<<(std::ostream& os, const basic_response& src)
+    inline std::ostream& operator<<(std::ostream& os, const basic_response& src)
     {
         os << src.encode();
         return os;
@@ -583,46 +1938,56 @@ namespace siddiqsoft
 
 
 #pragma region Literal Operators for rest_request
+    /// @brief The uri of the literal is validated and split at compile time: the Host header and the url part are
+    /// constants and only the request document is built at runtime. A malformed uri literal fails to compile.
     namespace restcl_literals
     {
-        [[nodiscard]] static rest_request<RESTMethodType::Get> operator"" _GET(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Get> operator"" _GET()
         {
-            return rest_request<RESTMethodType::Get>(SplitUri<>(std::string {s, sz}));
+            return rest_request<RESTMethodType::Get>(static_uri_parser<S>::value);
         }
 
-        [[nodiscard]] static rest_request<RESTMethodType::Delete> operator"" _DELETE(const char* s, size_t sz)
+
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Delete> operator"" _DELETE()
         {
-            return rest_request<RESTMethodType::Delete>(SplitUri<>(std::string {s, sz}));
+            return rest_request<RESTMethodType::Delete>(static_uri_parser<S>::value);
         }
 
 
-        static rest_request<RESTMethodType::Head> operator"" _HEAD(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Head> operator"" _HEAD()
         {
-            return rest_request<RESTMethodType::Head>(SplitUri<>(std::string {s, sz}));
+            return rest_request<RESTMethodType::Head>(static_uri_parser<S>::value);
         }
 
 
-        static rest_request<RESTMethodType::Options> operator"" _OPTIONS(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Options> operator"" _OPTIONS()
         {
-            return rest_request<RESTMethodType::Options>(SplitUri<>(std::string {s, sz}));
+            return rest_request<RESTMethodType::Options>(static_uri_parser<S>::value);
         }
 
 
-        static rest_request<RESTMethodType::Patch> operator"" _PATCH(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Patch> operator"" _PATCH()
         {
-            return rest_request<RESTMethodType::Patch>(SplitUri<>(std::string {s, sz}));
+            return rest_request<RESTMethodType::Patch>(static_uri_parser<S>::value);
         }
 
 
-        static rest_request<RESTMethodType::Post> operator"" _POST(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Post> operator"" _POST()
         {
-            return rest_request<RESTMethodType::Post>(SplitUri(std::string {s, sz}));
+            return rest_request<RESTMethodType::Post>(static_uri_parser<S>::value);
         }
 
 
-        static rest_request<RESTMethodType::Put> operator"" _PUT(const char* s, size_t sz)
+        template <fixed_string S>
+        [[nodiscard]] rest_request<RESTMethodType::Put> operator"" _PUT()
         {
-            return rest_request<RESTMethodType::Put>(SplitUri(std::string {s, sz}));
+            return rest_request<RESTMethodType::Put>(static_uri_parser<S>::value);
         }
     } // namespace restcl_literals
 #pragma endregion
@@ -639,21 +2004,21 @@ namespace siddiqsoft
  */
 
 template <>
-struct std::formatter<siddiqsoft::HTTPProtocolVersion> : std::formatter<std::string>
+struct std::formatter<siddiqsoft::HTTPProtocolVersion> : std::formatter<std::string_view>
 {
     auto format(const siddiqsoft::HTTPProtocolVersion& sv, std::format_context& ctx) const
     {
-        return std::formatter<std::string>::format(nlohmann::json(sv).get<std::string>(), ctx);
+        return std::formatter<std::string_view>::format(siddiqsoft::to_string_view(sv), ctx);
     }
 };
 
 
 template <>
-struct std::formatter<siddiqsoft::RESTMethodType> : std::formatter<std::string>
+struct std::formatter<siddiqsoft::RESTMethodType> : std::formatter<std::string_view>
 {
     auto format(const siddiqsoft::RESTMethodType& sv, std::format_context& ctx) const
     {
-        return std::formatter<std::string>::format(nlohmann::json(sv).get<std::string>(), ctx);
+        return std::formatter<std::string_view>::format(siddiqsoft::to_string_view(sv), ctx);
     }
 };
 
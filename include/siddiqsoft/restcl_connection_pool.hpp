@@ -0,0 +1,409 @@
+/*
+    restcl : Keep-alive connection pool shared by the backends
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_CONNECTION_POOL_HPP
+#define RESTCL_CONNECTION_POOL_HPP
+
+
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <format>
+#include <atomic>
+#include <optional>
+#include <charconv>
+
+
+#include "siddiqsoft/SplitUri.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Limits for the connection_pool
+    struct connection_pool_options
+    {
+        /// @brief Maximum number of idle connections kept per origin
+        size_t maxIdlePerOrigin {8};
+        /// @brief Maximum number of open (idle + in-use) connections per origin
+        size_t maxPerOrigin {64};
+        /// @brief Idle connections older than this are evicted
+        std::chrono::milliseconds maxIdleTime {std::chrono::seconds(30)};
+        /// @brief Maximum number of distinct origins tracked by the pool (rounded up to a power of two)
+        size_t maxOrigins {256};
+    };
+
+
+    /// @brief Keep-alive connection pool keyed by the origin (scheme, host, port).
+    /// The checkout/checkin/reserve/release operations on an origin are lock-free: each origin owns a fixed array of
+    /// idle slots which are claimed via compare-exchange. Origins are stored in an insert-only open addressing table
+    /// so the lookup is lock-free as well.
+    /// @tparam ConnT The connection handle (socket, HINTERNET, pointer). Must be copyable.
+    template <class ConnT>
+    class connection_pool
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        /// @brief Invoked to dispose a connection which the pool no longer retains
+        using evict_type = std::function<void(ConnT&)>;
+
+    private:
+        enum slot_state : uint8_t
+        {
+            Empty,
+            Busy,
+            Full
+        };
+
+        struct slot
+        {
+            std::atomic<uint8_t>   state {Empty};
+            ConnT                  conn {};
+            clock_type::time_point lastUsed {};
+        };
+
+    public:
+        /// @brief Per-origin state. The reference remains valid for the lifetime of the pool so callers may cache it.
+        class origin_bucket
+        {
+            friend class connection_pool;
+
+            std::string             key {};
+            std::atomic<size_t>     open {0};
+            size_t                  capacity {0};
+            std::unique_ptr<slot[]> slots {};
+
+        public:
+            origin_bucket(std::string_view k, size_t cap)
+                : key(k)
+                , capacity(cap)
+                , slots(std::make_unique<slot[]>(cap))
+            {
+            }
+
+            const std::string& origin() const { return key; }
+
+            /// @brief Number of open (idle + in-use) connections
+            size_t openCount() const { return open.load(std::memory_order_relaxed); }
+
+            /// @brief Number of idle connections
+            size_t idleCount() const
+            {
+                size_t n = 0;
+                for (size_t i = 0; i < capacity; i++) n += slots[i].state.load(std::memory_order_relaxed) == Full;
+                return n;
+            }
+        };
+
+    private:
+        connection_pool_options                         options {};
+        evict_type                                      onEvict {};
+        size_t                                          tableMask {0};
+        std::unique_ptr<std::atomic<origin_bucket*>[]> table {};
+
+        void evict(origin_bucket& b, ConnT& c)
+        {
+            b.open.fetch_sub(1, std::memory_order_acq_rel);
+            if (onEvict) onEvict(c);
+        }
+
+    public:
+        connection_pool(const connection_pool&)            = delete;
+        connection_pool& operator=(const connection_pool&) = delete;
+
+        /// @brief Creates the pool
+        /// @param opts Limits
+        /// @param evictor Disposes the connections which are evicted or remain at destruction
+        explicit connection_pool(const connection_pool_options& opts = {}, evict_type&& evictor = {})
+            : options(opts)
+            , onEvict(std::move(evictor))
+        {
+            size_t size = 1;
+            while (size < options.maxOrigins) size <<= 1;
+            tableMask = size - 1;
+            table     = std::make_unique<std::atomic<origin_bucket*>[]>(size);
+            for (size_t i = 0; i < size; i++) table[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+
+        ~connection_pool()
+        {
+            for (size_t i = 0; i <= tableMask; i++) {
+                if (auto* b = table[i].load(std::memory_order_acquire); b != nullptr) {
+                    for (size_t s = 0; s < b->capacity; s++) {
+                        if (b->slots[s].state.load(std::memory_order_acquire) == Full) evict(*b, b->slots[s].conn);
+                    }
+                    delete b;
+                }
+            }
+        }
+
+
+        /// @brief Builds the origin key for the given components
+        static std::string key(UriScheme scheme, std::string_view host, uint16_t port)
+        {
+            return std::format("{}://{}:{}", scheme == UriScheme::WebHttps ? "https" : "http", host, port);
+        }
+
+        /// @brief Builds the origin key into the destination (re-using its capacity)
+        static void key_to(std::string& dest, UriScheme scheme, std::string_view host, uint16_t port)
+        {
+            char digits[8];
+            auto [end, ec] = std::to_chars(digits, digits + sizeof(digits), port);
+            dest.assign(scheme == UriScheme::WebHttps ? "https" : "http").append("://").append(host).append(":").append(digits, end);
+        }
+
+
+        const connection_pool_options& limits() const { return options; }
+
+
+        /// @brief Find or create the bucket for the origin.
+        /// @param k Origin key (see key())
+        /// @return Pointer to the bucket or nullptr if the table of origins is full (the caller should not pool).
+        origin_bucket* origin(std::string_view k)
+        {
+            auto idx = std::hash<std::string_view> {}(k) & tableMask;
+
+            for (size_t probe = 0; probe <= tableMask; probe++, idx = (idx + 1) & tableMask) {
+                auto* b = table[idx].load(std::memory_order_acquire);
+                if (b == nullptr) {
+                    auto* nb = new origin_bucket(k, options.maxIdlePerOrigin);
+                    if (table[idx].compare_exchange_strong(b, nb, std::memory_order_acq_rel)) return nb;
+                    // Lost the race; the winner may be our origin
+                    delete nb;
+                }
+                if (b->key == k) return b;
+            }
+
+            return nullptr;
+        }
+
+
+        /// @brief Checkout an idle connection. Connections idle longer than maxIdleTime are evicted along the way.
+        /// @param b Origin
+        /// @return The connection if one is available
+        std::optional<ConnT> checkout(origin_bucket& b)
+        {
+            auto now = clock_type::now();
+
+            for (size_t i = 0; i < b.capacity; i++) {
+                auto& s        = b.slots[i];
+                uint8_t expect = Full;
+                if (!s.state.compare_exchange_strong(expect, Busy, std::memory_order_acquire)) continue;
+
+                ConnT conn  = std::move(s.conn);
+                auto  stale = (now - s.lastUsed) > options.maxIdleTime;
+                s.state.store(Empty, std::memory_order_release);
+
+                if (stale) {
+                    evict(b, conn);
+                    continue;
+                }
+                return conn;
+            }
+
+            return std::nullopt;
+        }
+
+
+        /// @brief Reserve room for a new connection to the origin
+        /// @param b Origin
+        /// @return true if the caller may open a new connection; it must eventually be returned via checkin() or release()
+        bool try_reserve(origin_bucket& b)
+        {
+            auto current = b.open.load(std::memory_order_relaxed);
+            while (current < options.maxPerOrigin) {
+                if (b.open.compare_exchange_weak(current, current + 1, std::memory_order_acq_rel)) return true;
+            }
+            return false;
+        }
+
+
+        /// @brief Return a healthy connection to the pool. If every idle slot is taken, the connection is evicted.
+        /// @param b Origin
+        /// @param conn The connection obtained via checkout() or opened after try_reserve()
+        /// @return true if the connection is retained by the pool
+        bool checkin(origin_bucket& b, ConnT conn)
+        {
+            for (size_t i = 0; i < b.capacity; i++) {
+                auto& s        = b.slots[i];
+                uint8_t expect = Empty;
+                if (!s.state.compare_exchange_strong(expect, Busy, std::memory_order_acquire)) continue;
+
+                s.conn     = std::move(conn);
+                s.lastUsed = clock_type::now();
+                s.state.store(Full, std::memory_order_release);
+                return true;
+            }
+
+            evict(b, conn);
+            return false;
+        }
+
+
+        /// @brief A connection obtained via checkout() or try_reserve() has been closed by the caller
+        /// @param b Origin
+        void release(origin_bucket& b) { b.open.fetch_sub(1, std::memory_order_acq_rel); }
+
+
+        /// @brief Remove the given idle connection (for instance the server closed it)
+        /// @param b Origin
+        /// @param conn The idle connection
+        /// @return true if the connection was found; the caller owns it and must close it. The open count is released.
+        bool remove(origin_bucket& b, const ConnT& conn)
+        {
+            for (size_t i = 0; i < b.capacity; i++) {
+                auto& s        = b.slots[i];
+                uint8_t expect = Full;
+                if (!s.state.compare_exchange_strong(expect, Busy, std::memory_order_acquire)) continue;
+
+                if (s.conn == conn) {
+                    s.conn = {};
+                    s.state.store(Empty, std::memory_order_release);
+                    release(b);
+                    return true;
+                }
+                s.state.store(Full, std::memory_order_release);
+            }
+
+            return false;
+        }
+
+
+        /// @brief Evict every idle connection older than maxIdleTime
+        /// @return Number of connections evicted
+        size_t evict_idle()
+        {
+            size_t count = 0;
+            auto   now   = clock_type::now();
+
+            for (size_t i = 0; i <= tableMask; i++) {
+                auto* b = table[i].load(std::memory_order_acquire);
+                if (b == nullptr) continue;
+
+                for (size_t si = 0; si < b->capacity; si++) {
+                    auto& s        = b->slots[si];
+                    uint8_t expect = Full;
+                    if (!s.state.compare_exchange_strong(expect, Busy, std::memory_order_acquire)) continue;
+
+                    if ((now - s.lastUsed) > options.maxIdleTime) {
+                        ConnT conn = std::move(s.conn);
+                        s.state.store(Empty, std::memory_order_release);
+                        evict(*b, conn);
+                        count++;
+                    }
+                    else {
+                        s.state.store(Full, std::memory_order_release);
+                    }
+                }
+            }
+
+            return count;
+        }
+
+
+        /// @brief RAII helper for synchronous backends: returns the connection to the pool on scope exit unless discarded.
+        class lease
+        {
+            connection_pool* pool {nullptr};
+            origin_bucket*   bucket {nullptr};
+            std::optional<ConnT> conn {};
+
+        public:
+            lease() = default;
+            lease(connection_pool& p, origin_bucket& b, ConnT c)
+                : pool(&p)
+                , bucket(&b)
+                , conn(std::move(c))
+            {
+            }
+            lease(const lease&)            = delete;
+            lease& operator=(const lease&) = delete;
+            lease(lease&& src) noexcept
+                : pool(src.pool)
+                , bucket(src.bucket)
+                , conn(std::move(src.conn))
+            {
+                src.conn.reset();
+            }
+
+            lease& operator=(lease&& src) noexcept
+            {
+                if (this != &src) {
+                    if (pool && bucket && conn) pool->checkin(*bucket, std::move(*conn));
+                    pool   = src.pool;
+                    bucket = src.bucket;
+                    conn   = std::move(src.conn);
+                    src.conn.reset();
+                }
+                return *this;
+            }
+
+            ~lease()
+            {
+                if (pool && bucket && conn) pool->checkin(*bucket, std::move(*conn));
+            }
+
+            ConnT& get() { return *conn; }
+            explicit operator bool() const { return conn.has_value(); }
+
+            /// @brief The connection is unusable; close it instead of returning it to the pool
+            void discard()
+            {
+                if (pool && bucket && conn) pool->evict(*bucket, *conn);
+                conn.reset();
+            }
+        };
+
+
+        /// @brief Checkout an idle connection or open a new one if the per-origin limit permits.
+        /// @param b Origin
+        /// @param connect Callable returning std::optional<ConnT>; invoked when no idle connection is available
+        /// @return A lease which is empty if no connection could be obtained
+        template <class F>
+        lease acquire(origin_bucket& b, F&& connect)
+        {
+            if (auto c = checkout(b); c) return lease(*this, b, std::move(*c));
+            if (!try_reserve(b)) return {};
+            if (std::optional<ConnT> c = connect(); c) return lease(*this, b, std::move(*c));
+            release(b);
+            return {};
+        }
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_CONNECTION_POOL_HPP
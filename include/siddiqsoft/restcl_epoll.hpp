@@ -0,0 +1,1113 @@
+/*
+    restcl : epoll implementation for Linux
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCLEPOLL_HPP
+#define RESTCLEPOLL_HPP
+
+#if defined(__linux__)
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <format>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <array>
+#include <span>
+#include <unordered_map>
+#include <semaphore>
+#include <stop_token>
+#include <cerrno>
+#include <cctype>
+#include <cstring>
+#include <charconv>
+#include <optional>
+#include <algorithm>
+#include <utility>
+#include <system_error>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+#include "nlohmann/json.hpp"
+#include "restcl.hpp"
+#include "restcl_connection_pool.hpp"
+#include "restcl_http_parser.hpp"
+#include "restcl_timer_wheel.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Linux implementation of the basic_restclient
+    /// A single event loop thread multiplexes every socket via epoll so thousands of HTTP/1.1 requests may be in-flight
+    /// without parking a thread per request. Connections are kept alive in a connection_pool and reused per origin;
+    /// requests beyond the per-origin limit wait for a connection to become available.
+    /// Callbacks are invoked on the event loop thread; they must not block.
+    /// IO errors are reported as `ERRNO_BASE + errno` so they never overlap the HTTP status range.
+    /// A request whose deadline passes before it is sent completes with restcl_status::Timeout. A request in progress at
+    /// its deadline or past the limit of its phase (request_timeouts) fails with `ERRNO_BASE + ETIMEDOUT` and its
+    /// connection is closed. The limits are tracked on a timer_wheel by the loop thread.
+    /// Host names are looked up by a resolver thread so a slow lookup never stalls the loop; the connection falls back
+    /// through every address of the host until one accepts it.
+    /// A request whose stop token is stopped is taken off the wait for a connection or has its connection closed, and
+    /// completes with restcl_status::Cancelled.
+    /// @note Only the `http` scheme is supported; `https` requests complete with `ERRNO_BASE + EPROTONOSUPPORT`.
+    class EpollRESTClient : public basic_restclient
+    {
+    public:
+        static const int ERRNO_BASE {20000};
+
+    private:
+        using clock_type = std::chrono::steady_clock;
+
+        static const size_t READBUFFERSIZE {8192};
+
+        /// @brief Completed transactions kept for re-use by the next send()
+        static const size_t MAX_POOLED_TRANSACTIONS {256};
+
+        /// @brief Hosts whose addresses are cached; expired entries and then the ones nearest to expiry make room
+        static const size_t MAX_CACHED_HOSTS {1024};
+
+
+        /// @brief Incremental reader for a HTTP/1.1 response; accepts the bytes as they arrive from the socket.
+        /// The bytes are parsed in place; only an incomplete line of the head is kept for the next receive.
+        struct response_reader
+        {
+            http_response_parser parser {};
+            bool                 received {false}; // any part of the response has arrived
+            std::string          buffer {};
+            content_receiver     content {};
+            rest_response        resp {};
+
+            void on_status(std::string_view version, uint32_t status, std::string_view reason)
+            {
+                resp.setStatusLine(version, status, reason);
+            }
+
+            void on_header(std::string_view name, std::string_view value) { resp.headers().receive(name, value); }
+
+            void on_headers_complete() { content.begin(resp.headers()); }
+
+            void on_body(std::string_view part) { content.append(part); }
+
+            /// @brief Feed the received bytes
+            /// @return false if the response is malformed
+            bool feed(const char* data, size_t len)
+            {
+                received = true;
+                if (buffer.empty()) {
+                    auto used = parser.parse({data, len}, *this);
+                    if (!parser.complete()) buffer.append(data + used, len - used);
+                }
+                else {
+                    buffer.append(data, len);
+                    buffer.erase(0, parser.parse(buffer, *this));
+                }
+                return !parser.failed();
+            }
+
+            /// @brief The peer closed the connection
+            /// @return true if the response is complete
+            bool finish() { return parser.finish(); }
+
+            bool complete() const { return parser.complete(); }
+
+            /// @brief Moves the content into the response object; the headers are added as they are parsed
+            rest_response& response()
+            {
+                content.end(resp);
+                return resp;
+            }
+
+            /// @brief Prepare for the next response; the buffers (and the response unless the callback took it) are re-used
+            void reset()
+            {
+                parser   = http_response_parser {};
+                received = false;
+                buffer.clear();
+                content.reset(resp);
+                resp.reset();
+            }
+        };
+
+
+        struct connection;
+        struct transaction;
+        struct event_loop;
+        using pool_type     = connection_pool<connection*>;
+        using waitlist_type = std::deque<std::unique_ptr<transaction>>;
+
+        /// @brief The stop callback of a transaction; hands the transaction to the loop thread
+        struct canceller
+        {
+            event_loop*  loop;
+            transaction* t;
+
+            void operator()() const noexcept { loop->requestCancel(t); }
+        };
+
+        /// @brief A single request/response exchange. Transactions are pooled by the event loop; the request slot, the
+        /// response and the buffers retain their capacity so that a steady stream of sends does not allocate on either thread.
+        /// The timer is armed for the earlier of the deadline and the limit of the current phase.
+        struct transaction : timer_wheel::timer
+        {
+            std::optional<basic_request>                 owned {};
+            basic_request*                               request {nullptr};
+            basic_movecallbacktype                       onComplete {};  // invoked once the response is available (or the IO failed)
+            transaction*                                 next {nullptr}; // link in the submission queue or the pool
+            std::string                                  origin {};
+            std::string                                  host {};
+            std::string                                  port {};
+            bool                                         secure {false};
+            std::string                                  out {};  // request line and headers
+            std::span<const std::byte>                   body {}; // references the request's content; never copied
+            size_t                                       written {0};
+            response_reader                              reader {};
+            bool                                         retried {false};
+            bool                                         idempotent {false}; // may be resent on a fresh connection
+            clock_type::time_point                       deadline {clock_type::time_point::max()}; // includes the total of the timeouts
+            request_timeouts                             timeouts {};
+            connection*                                  conn {nullptr};     // while on a connection
+            waitlist_type*                               queuedOn {nullptr}; // while waiting for a connection or a lookup
+            size_t                                       attempt {0};        // the address of the host being connected
+            std::optional<std::stop_callback<canceller>> onCancel {};
+            std::atomic_bool                             cancelQueued {false}; // held by the queue of cancellations
+            transaction*                                 cancelNext {nullptr};
+            bool                                         cancelled {false};
+            bool                                         done {false}; // completed while queued for cancellation
+        };
+
+
+        struct connection
+        {
+            enum class phase
+            {
+                Connecting,
+                Writing,
+                Reading,
+                Idle
+            };
+
+            int                          fd {-1};
+            phase                        state {phase::Connecting};
+            pool_type::origin_bucket*    bucket {nullptr};
+            std::unique_ptr<transaction> active {};
+            bool                         reused {false};
+        };
+
+
+        /// @brief Owns the epoll instance, the loop thread and every connection.
+        /// Kept behind a pointer so the client may be moved while the loop is running.
+        struct event_loop
+        {
+            struct endpoint
+            {
+                sockaddr_storage addr {};
+                socklen_t        len {0};
+            };
+
+            struct resolved
+            {
+                std::vector<endpoint>                 endpoints {};
+                std::chrono::steady_clock::time_point expires {};
+            };
+
+            /// @brief A host name lookup performed by the resolver thread
+            struct lookup
+            {
+                std::string           origin {};
+                std::string           host {};
+                std::string           port {};
+                std::vector<endpoint> endpoints {}; // empty if the lookup failed
+            };
+
+            int                                                            epfd {-1};
+            int                                                            evfd {-1};
+            std::mutex                                                     submitLock {};
+            transaction*                                                   submitHead {nullptr}; // intrusive FIFO
+            transaction*                                                   submitTail {nullptr};
+            bool                                                           closed {false}; // no further submissions are run
+            std::atomic<transaction*>                                      cancels {nullptr}; // intrusive LIFO
+            std::mutex                                                     poolLock {};
+            transaction*                                                   pooled {nullptr}; // intrusive LIFO
+            size_t                                                         pooledCount {0};
+            std::unordered_map<connection*, std::unique_ptr<connection>>   connections {};
+            std::vector<std::unique_ptr<connection>>                       graveyard {}; // destroyed; freed after the batch of events
+            std::unordered_map<pool_type::origin_bucket*, waitlist_type>   waiting {};
+            std::unordered_map<std::string, resolved>                      dnsCache {};
+            std::chrono::seconds                                           dnsTimeout {60};
+            std::unordered_map<std::string, waitlist_type>                 resolving {}; // waiting for the lookup of the origin
+            std::mutex                                                     lookupLock {};
+            std::condition_variable_any                                    lookupReady {};
+            std::deque<lookup>                                             lookups {};  // for the resolver thread
+            std::vector<lookup>                                            lookedUp {}; // for the loop thread
+            std::jthread                                                   resolver {}; // started by the first lookup
+            timer_wheel                                                    timers {};
+            pool_type                                                      pool;
+            std::jthread                                                   worker {};
+
+            explicit event_loop(const connection_pool_options& opts)
+                : pool(opts, [this](connection*& c) { destroy(c); })
+            {
+                epfd = epoll_create1(EPOLL_CLOEXEC);
+                evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (epfd < 0 || evfd < 0) throw std::system_error(errno, std::system_category(), "epoll_create1/eventfd");
+
+                epoll_event ev {.events = EPOLLIN, .data = {.ptr = nullptr}};
+                epoll_ctl(epfd, EPOLL_CTL_ADD, evfd, &ev);
+
+                worker = std::jthread([this](std::stop_token st) { run(st); });
+            }
+
+            ~event_loop()
+            {
+                worker.request_stop();
+                wake();
+                if (worker.joinable()) worker.join();
+                // A lookup in progress is waited for
+                resolver.request_stop();
+                if (resolver.joinable()) resolver.join();
+                // Completed transactions which wait in the queue of cancellations belong to it
+                for (auto* t = cancels.exchange(nullptr); t != nullptr;) {
+                    auto* c = std::exchange(t, t->cancelNext);
+                    c->cancelQueued = false;
+                    if (c->done) delete c;
+                }
+                for (auto* t = pooled; t != nullptr;) delete std::exchange(t, t->next);
+                if (evfd >= 0) ::close(evfd);
+                if (epfd >= 0) ::close(epfd);
+            }
+
+            bool onLoopThread() const { return std::this_thread::get_id() == worker.get_id(); }
+
+            void wake()
+            {
+                uint64_t one = 1;
+                [[maybe_unused]] auto rc = ::write(evfd, &one, sizeof(one));
+            }
+
+            /// @brief A transaction from the pool or a new one if the pool is empty
+            std::unique_ptr<transaction> acquire()
+            {
+                {
+                    std::scoped_lock<std::mutex> l(poolLock);
+                    if (pooled != nullptr) {
+                        pooledCount--;
+                        return std::unique_ptr<transaction>(std::exchange(pooled, pooled->next));
+                    }
+                }
+                return std::make_unique<transaction>();
+            }
+
+            /// @brief Reset the transaction (on the loop thread) and return it to the pool
+            void recycle(std::unique_ptr<transaction> t)
+            {
+                if (t->onCancel) {
+                    // Waits for the stop callback if it runs on another thread
+                    t->onCancel.reset();
+                    if (t->cancelQueued.load(std::memory_order_acquire)) {
+                        // Recycled once the queue of cancellations is drained
+                        t->done = true;
+                        t.release();
+                        return;
+                    }
+                }
+                t->cancelled = false;
+                // The request slot is emptied for the next one to be moved into; destroying it would allocate
+                if (t->owned) t->owned->discard();
+                t->request    = nullptr;
+                t->onComplete = nullptr;
+                t->secure     = false;
+                t->out.clear();
+                t->reader.reset();
+                t->body       = {};
+                t->written    = 0;
+                t->retried    = false;
+                t->idempotent = false;
+                t->deadline   = clock_type::time_point::max();
+                t->timeouts   = {};
+                t->conn       = nullptr;
+                t->queuedOn   = nullptr;
+                t->attempt    = 0;
+
+                std::scoped_lock<std::mutex> l(poolLock);
+                if (pooledCount < MAX_POOLED_TRANSACTIONS) {
+                    t->next = pooled;
+                    pooled  = t.release();
+                    pooledCount++;
+                }
+            }
+
+            /// @brief Queue the transaction for the loop thread. Once the loop has stopped the transaction fails at once with
+            /// ECANCELED on the calling thread.
+            void submit(std::unique_ptr<transaction>&& t)
+            {
+                {
+                    std::unique_lock<std::mutex> l(submitLock);
+                    if (closed) {
+                        l.unlock();
+                        return fail(std::move(t), ECANCELED, "shutdown");
+                    }
+                    // A stop requested already queues the transaction for cancellation at once
+                    if (auto& token = t->request->getStopToken(); token.stop_possible()) t->onCancel.emplace(token, canceller {this, t.get()});
+                    auto* p = t.release();
+                    p->next = nullptr;
+                    if (submitTail != nullptr) submitTail->next = p;
+                    else
+                        submitHead = p;
+                    submitTail = p;
+                }
+                wake();
+            }
+
+            /// @brief Detach the queued submissions
+            /// @return The first of the list linked via next
+            transaction* takeSubmissions()
+            {
+                std::scoped_lock<std::mutex> l(submitLock);
+                submitTail = nullptr;
+                return std::exchange(submitHead, nullptr);
+            }
+
+            /// @brief Invoke the completion with the request and the response and recycle the transaction
+            void complete(std::unique_ptr<transaction> t, basic_response& resp)
+            {
+                timers.cancel(*t);
+                try {
+                    if (t->onComplete) t->onComplete(std::move(*t->request), std::move(resp));
+                }
+                catch (const std::exception&) {
+                }
+                recycle(std::move(t));
+            }
+
+            void fail(std::unique_ptr<transaction> t, int err, std::string_view stage)
+            {
+                if (t->cancelled) return abandon(std::move(t));
+                rest_response resp {ERRNO_BASE + err, std::format("{} failed; {}", stage, std::strerror(err))};
+                complete(std::move(t), resp);
+            }
+
+            /// @brief The deadline passed before the request was sent
+            void expire(std::unique_ptr<transaction> t)
+            {
+                rest_response resp {restcl_status::Timeout, "The deadline passed before the request was sent"};
+                complete(std::move(t), resp);
+            }
+
+            void abandon(std::unique_ptr<transaction> t)
+            {
+                rest_response resp {restcl_status::Cancelled, "The request was cancelled"};
+                complete(std::move(t), resp);
+            }
+
+            /// @brief Queue the transaction for cancellation by the loop thread; invoked by its stop callback on the thread
+            /// which requested the stop
+            void requestCancel(transaction* t)
+            {
+                t->cancelQueued.store(true, std::memory_order_relaxed);
+                auto* head = cancels.load(std::memory_order_relaxed);
+                do {
+                    t->cancelNext = head;
+                } while (!cancels.compare_exchange_weak(head, t, std::memory_order_release, std::memory_order_relaxed));
+                wake();
+            }
+
+            void drainCancels()
+            {
+                for (auto* t = cancels.exchange(nullptr, std::memory_order_acquire); t != nullptr;) {
+                    auto* c = std::exchange(t, t->cancelNext);
+                    c->cancelQueued.store(false, std::memory_order_relaxed);
+                    if (c->done) {
+                        c->done = false;
+                        recycle(std::unique_ptr<transaction>(c));
+                    }
+                    else {
+                        cancel(*c);
+                    }
+                }
+            }
+
+            /// @brief A waiting transaction is removed; one on a connection has the connection closed; one which is yet to
+            /// start is completed by start()
+            void cancel(transaction& t)
+            {
+                t.cancelled = true;
+                if (t.queuedOn != nullptr) {
+                    if (auto owned = unqueue(t); owned) abandon(std::move(owned));
+                }
+                else if (auto* c = t.conn; c != nullptr) {
+                    t.retried = true;
+                    close(c, ECANCELED, "cancel");
+                }
+            }
+
+            void run(std::stop_token st)
+            {
+                std::array<epoll_event, 256> events {};
+
+                while (!st.stop_requested()) {
+                    // Wake for the next timer or else once a second for the eviction of idle connections
+                    auto due     = timers.next_timeout(clock_type::now());
+                    auto timeout = due ? static_cast<int>(std::min<int64_t>(due->count(), 1000)) : 1000;
+                    auto n       = epoll_wait(epfd, events.data(), static_cast<int>(events.size()), timeout);
+
+                    for (int i = 0; i < n; i++) {
+                        if (events[i].data.ptr == nullptr) {
+                            uint64_t count {0};
+                            [[maybe_unused]] auto rc = ::read(evfd, &count, sizeof(count));
+                            drainSubmissions();
+                            drainLookups();
+                            drainCancels();
+                        }
+                        else {
+                            onEvent(static_cast<connection*>(events[i].data.ptr));
+                        }
+                    }
+
+                    timers.advance(clock_type::now(), [this](timer_wheel::timer& t) { onTimeout(static_cast<transaction&>(t)); });
+                    evictIdle();
+                    // No event of the batch refers to the connections destroyed while handling it any longer
+                    graveyard.clear();
+                }
+
+                shutdown();
+            }
+
+            void drainSubmissions()
+            {
+                auto now = clock_type::now();
+                for (auto* t = takeSubmissions(); t != nullptr;) {
+                    if (t->timeouts.total.count() > 0) t->deadline = std::min(t->deadline, now + t->timeouts.total);
+                    start(std::unique_ptr<transaction>(std::exchange(t, t->next)));
+                }
+            }
+
+            /// @brief Arm the timer of the transaction for the phase which begins now
+            /// @param limit The limit of the phase; zero leaves only the deadline
+            void arm(transaction& t, std::chrono::milliseconds limit)
+            {
+                auto when = t.deadline;
+                if (limit.count() > 0) when = std::min(when, clock_type::now() + limit);
+                if (when == clock_type::time_point::max()) timers.cancel(t);
+                else
+                    timers.schedule(t, when);
+            }
+
+            /// @brief Take the transaction off the wait for a connection or a lookup
+            std::unique_ptr<transaction> unqueue(transaction& t)
+            {
+                auto& list = *t.queuedOn;
+                auto  it   = std::ranges::find(list, &t, &std::unique_ptr<transaction>::get);
+                if (it == list.end()) return {};
+                auto owned = std::move(*it);
+                list.erase(it);
+                owned->queuedOn = nullptr;
+                return owned;
+            }
+
+            /// @brief A waiting transaction has not been sent and expires (or fails if the lookup of its host exceeds the
+            /// connect limit); one in progress fails and its connection is closed since the state of the exchange is unknown
+            void onTimeout(transaction& t)
+            {
+                if (t.queuedOn != nullptr) {
+                    if (auto owned = unqueue(t); owned) {
+                        if (owned->deadline <= clock_type::now()) expire(std::move(owned));
+                        else
+                            fail(std::move(owned), ETIMEDOUT, "getaddrinfo()");
+                    }
+                    return;
+                }
+
+                if (auto* c = t.conn; c != nullptr) {
+                    t.retried = true;
+                    close(c,
+                          ETIMEDOUT,
+                          c->state == connection::phase::Connecting ? "connect()"
+                          : c->state == connection::phase::Writing  ? "send()"
+                                                                    : "recv()");
+                }
+            }
+
+            /// @brief Begin the transaction on an idle connection if one is available for the origin; otherwise connect.
+            /// A transaction whose deadline passed completes without touching the network.
+            void start(std::unique_ptr<transaction> t)
+            {
+                // The stop may be requested before its cancellation reaches the loop
+                if (t->cancelled || t->request->getStopToken().stop_requested()) return abandon(std::move(t));
+                if (t->deadline <= clock_type::now()) return expire(std::move(t));
+
+                if (t->secure) {
+                    rest_response resp {ERRNO_BASE + EPROTONOSUPPORT, "https is not supported by EpollRESTClient"};
+                    return complete(std::move(t), resp);
+                }
+
+                // Origins beyond the capacity of the pool are served by unpooled connections
+                auto* bucket = pool.origin(t->origin);
+                if (bucket != nullptr) {
+                    if (auto idle = pool.checkout(*bucket); idle) return assign(*idle, std::move(t));
+                }
+
+                const endpoint* addr = endpointOf(*t);
+                if (addr == nullptr) return awaitLookup(std::move(t));
+
+                if (bucket != nullptr && !pool.try_reserve(*bucket)) {
+                    // At the per-origin limit; the next connection to finish picks it up
+                    auto& list  = waiting[bucket];
+                    t->queuedOn = &list;
+                    arm(*t, {});
+                    list.push_back(std::move(t));
+                    return;
+                }
+
+                int fd = ::socket(addr->addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+                if (fd < 0) {
+                    auto err = errno;
+                    if (bucket) pool.release(*bucket);
+                    return fail(std::move(t), err, "socket()");
+                }
+
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+                auto conn    = std::make_unique<connection>();
+                conn->fd     = fd;
+                conn->bucket = bucket;
+                t->conn      = conn.get();
+                arm(*t, t->timeouts.connect);
+                conn->active = std::move(t);
+                auto* c      = conn.get();
+                connections.emplace(c, std::move(conn));
+
+                epoll_event ev {.events = EPOLLOUT, .data = {.ptr = c}};
+                epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+
+                if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr->addr), addr->len) == 0) {
+                    c->state = connection::phase::Writing;
+                    arm(*c->active, {});
+                    onWritable(c);
+                }
+                else if (errno != EINPROGRESS) {
+                    auto err = errno;
+                    close(c, err, "connect()");
+                }
+            }
+
+            /// @brief Run the transaction over an established (idle) connection
+            void assign(connection* c, std::unique_ptr<transaction> t)
+            {
+                c->reused = true;
+                t->conn   = c;
+                arm(*t, {});
+                c->active = std::move(t);
+                c->state  = connection::phase::Writing;
+                watch(c, EPOLLOUT);
+                onWritable(c);
+            }
+
+            /// @brief The address of the host for the current attempt of the transaction
+            /// @return nullptr if the host must be looked up
+            const endpoint* endpointOf(const transaction& t) const
+            {
+                auto it = dnsCache.find(t.origin);
+                if (it == dnsCache.end() || it->second.expires <= clock_type::now()) return nullptr;
+                return t.attempt < it->second.endpoints.size() ? &it->second.endpoints[t.attempt] : nullptr;
+            }
+
+            /// @brief True if the host of the transaction has an address after the one of the current attempt
+            bool hasNextEndpoint(const transaction& t) const
+            {
+                auto it = dnsCache.find(t.origin);
+                return it != dnsCache.end() && t.attempt + 1 < it->second.endpoints.size();
+            }
+
+            /// @brief Park the transaction until the host is looked up; one lookup serves every transaction to the origin
+            void awaitLookup(std::unique_ptr<transaction> t)
+            {
+                t->attempt             = 0;
+                auto [it, firstWaiter] = resolving.try_emplace(t->origin);
+                if (firstWaiter) {
+                    if (!resolver.joinable()) resolver = std::jthread([this](std::stop_token st) { resolve(st); });
+                    {
+                        std::scoped_lock<std::mutex> l(lookupLock);
+                        auto&                        q = lookups.emplace_back();
+                        q.origin                       = t->origin;
+                        q.host                         = t->host;
+                        q.port                         = t->port;
+                    }
+                    lookupReady.notify_one();
+                }
+                t->queuedOn = &it->second;
+                // The lookup counts towards the connect limit
+                arm(*t, t->timeouts.connect);
+                it->second.push_back(std::move(t));
+            }
+
+            /// @brief The resolver thread; performs the blocking getaddrinfo() and hands the result to the loop thread
+            void resolve(std::stop_token st)
+            {
+                while (true) {
+                    lookup q {};
+                    {
+                        std::unique_lock<std::mutex> l(lookupLock);
+                        if (!lookupReady.wait(l, st, [this] { return !lookups.empty(); })) return;
+                        q = std::move(lookups.front());
+                        lookups.pop_front();
+                    }
+
+                    addrinfo hints {};
+                    hints.ai_flags    = AI_ADDRCONFIG;
+                    hints.ai_family   = AF_UNSPEC;
+                    hints.ai_socktype = SOCK_STREAM;
+                    addrinfo* result {nullptr};
+                    if (getaddrinfo(q.host.c_str(), q.port.c_str(), &hints, &result) == 0) {
+                        for (auto* a = result; a != nullptr; a = a->ai_next) {
+                            auto& e = q.endpoints.emplace_back();
+                            std::memcpy(&e.addr, a->ai_addr, a->ai_addrlen);
+                            e.len = static_cast<socklen_t>(a->ai_addrlen);
+                        }
+                        freeaddrinfo(result);
+                    }
+
+                    {
+                        std::scoped_lock<std::mutex> l(lookupLock);
+                        lookedUp.push_back(std::move(q));
+                    }
+                    wake();
+                }
+            }
+
+            /// @brief Cache the completed lookups and resume the transactions which waited for them
+            void drainLookups()
+            {
+                std::vector<lookup> done {};
+                {
+                    std::scoped_lock<std::mutex> l(lookupLock);
+                    if (lookedUp.empty()) return;
+                    done.swap(lookedUp);
+                }
+
+                auto now = clock_type::now();
+                for (auto& q : done) {
+                    bool found = !q.endpoints.empty();
+                    if (found) {
+                        if (!dnsCache.contains(q.origin)) makeCacheRoom(now);
+                        dnsCache[q.origin] = resolved {std::move(q.endpoints), now + dnsTimeout};
+                    }
+
+                    auto it = resolving.find(q.origin);
+                    if (it == resolving.end()) continue;
+                    auto list = std::move(it->second);
+                    resolving.erase(it);
+                    for (auto& t : list) {
+                        t->queuedOn = nullptr;
+                        if (found) start(std::move(t));
+                        else
+                            fail(std::move(t), EHOSTUNREACH, "getaddrinfo()");
+                    }
+                }
+            }
+
+            /// @brief Keep the cache of addresses within MAX_CACHED_HOSTS: drop the expired hosts or else the one nearest to expiry
+            void makeCacheRoom(clock_type::time_point now)
+            {
+                if (dnsCache.size() < MAX_CACHED_HOSTS) return;
+                std::erase_if(dnsCache, [now](const auto& e) { return e.second.expires <= now; });
+                if (dnsCache.size() < MAX_CACHED_HOSTS) return;
+                dnsCache.erase(std::ranges::min_element(dnsCache, {}, [](const auto& e) { return e.second.expires; }));
+            }
+
+            void watch(connection* c, uint32_t events)
+            {
+                epoll_event ev {.events = events, .data = {.ptr = c}};
+                epoll_ctl(epfd, EPOLL_CTL_MOD, c->fd, &ev);
+            }
+
+            void onEvent(connection* c)
+            {
+                // Destroyed earlier in the same batch of events
+                if (c->fd < 0) return;
+
+                switch (c->state) {
+                    case connection::phase::Connecting: {
+                        int       err {0};
+                        socklen_t len = sizeof(err);
+                        getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                        if (err != 0) return close(c, err, "connect()");
+                        c->state = connection::phase::Writing;
+                        arm(*c->active, {});
+                        return onWritable(c);
+                    }
+                    case connection::phase::Writing: return onWritable(c);
+                    case connection::phase::Reading: return onReadable(c);
+                    case connection::phase::Idle:
+                        // The server closed (or wrote to) an idle connection; it cannot be reused.
+                        return close(c, 0, {});
+                }
+            }
+
+            void onWritable(connection* c)
+            {
+                auto& t     = *c->active;
+                auto  total = t.out.length() + t.body.size();
+                while (t.written < total) {
+                    // Gather the remainder of the head and the body into a single call
+                    std::array<iovec, 2> iov {};
+                    size_t               n = 0;
+                    if (t.written < t.out.length()) {
+                        iov[n++] = {t.out.data() + t.written, t.out.length() - t.written};
+                    }
+                    if (!t.body.empty()) {
+                        auto offset = t.written > t.out.length() ? t.written - t.out.length() : 0;
+                        iov[n++]    = {const_cast<std::byte*>(t.body.data()) + offset, t.body.size() - offset};
+                    }
+
+                    msghdr msg {};
+                    msg.msg_iov    = iov.data();
+                    msg.msg_iovlen = n;
+                    auto rc        = ::sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+                    if (rc < 0) {
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                        if (errno == EINTR) continue;
+                        return close(c, errno, "send()");
+                    }
+                    t.written += static_cast<size_t>(rc);
+                }
+
+                c->state = connection::phase::Reading;
+                arm(t, t.timeouts.firstByte);
+                watch(c, EPOLLIN | EPOLLRDHUP);
+            }
+
+            void onReadable(connection* c)
+            {
+                char buf[READBUFFERSIZE];
+                auto& t = *c->active;
+
+                while (true) {
+                    auto rc = ::recv(c->fd, buf, sizeof(buf), 0);
+                    if (rc > 0) {
+                        // The first byte ends the wait for the response; the deadline remains
+                        if (!t.reader.received && t.timeouts.firstByte.count() > 0) arm(t, {});
+                        if (!t.reader.feed(buf, static_cast<size_t>(rc))) return close(c, EPROTO, "recv()");
+                        if (t.reader.complete()) return release(c);
+                        continue;
+                    }
+                    if (rc == 0) {
+                        if (t.reader.finish()) return release(c);
+                        return close(c, ECONNRESET, "recv()");
+                    }
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+                    if (errno == EINTR) continue;
+                    return close(c, errno, "recv()");
+                }
+            }
+
+            /// @brief Deliver the completed response and hand the connection to the next waiting transaction or park it
+            /// in the pool for reuse if permitted
+            void release(connection* c)
+            {
+                auto  t         = std::move(c->active);
+                t->conn         = nullptr;
+                bool  keepAlive = t->reader.parser.keep_alive() && (c->bucket != nullptr);
+                auto& resp      = t->reader.response();
+                complete(std::move(t), resp);
+
+                if (!keepAlive) return close(c, 0, {});
+
+                if (auto next = nextWaiting(c->bucket); next) return assign(c, std::move(next));
+
+                c->state = connection::phase::Idle;
+                watch(c, EPOLLIN | EPOLLRDHUP);
+                // The pool disposes the connection (via destroy) if it has no room for it
+                pool.checkin(*c->bucket, c);
+            }
+
+            /// @brief The next waiting transaction for the origin; those whose deadline passed while waiting are expired
+            std::unique_ptr<transaction> nextWaiting(pool_type::origin_bucket* bucket)
+            {
+                if (auto it = waiting.find(bucket); it != waiting.end()) {
+                    auto now = clock_type::now();
+                    while (!it->second.empty()) {
+                        auto t = std::move(it->second.front());
+                        it->second.pop_front();
+                        t->queuedOn = nullptr;
+                        if (t->deadline <= now) expire(std::move(t));
+                        else
+                            return t;
+                    }
+                }
+                return {};
+            }
+
+            /// @brief Close the socket and forget the connection. The pool accounting is the caller's responsibility.
+            /// The connection is freed once the current batch of events is handled as a later event of the batch may still
+            /// refer to it.
+            void destroy(connection* c)
+            {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, c->fd, nullptr);
+                ::close(c->fd);
+                c->fd = -1;
+                if (auto it = connections.find(c); it != connections.end()) {
+                    graveyard.push_back(std::move(it->second));
+                    connections.erase(it);
+                }
+            }
+
+            /// @brief Close the connection; fails the active transaction (if any) with the given error.
+            /// A connection refused by one address of the host, or not established within the connect limit, is attempted on
+            /// the next unless the deadline of the request has passed.
+            /// A stale keep-alive connection which fails before any response bytes arrived is retried once if the method is
+            /// idempotent; otherwise the request may have been applied by the server and fails with restcl_status::Retryable.
+            void close(connection* c, int err, std::string_view stage)
+            {
+                auto* bucket = c->bucket;
+                if (bucket != nullptr) {
+                    if (c->state == connection::phase::Idle) {
+                        // Already disposed if the pool no longer holds it
+                        if (!pool.remove(*bucket, c)) return;
+                    }
+                    else {
+                        pool.release(*bucket);
+                    }
+                }
+
+                auto t     = std::move(c->active);
+                if (t) t->conn = nullptr;
+                bool stale = t && c->reused && !t->retried && !t->reader.received;
+                bool next  = t && c->state == connection::phase::Connecting && err != ECANCELED && hasNextEndpoint(*t) &&
+                            (err != ETIMEDOUT || t->deadline > clock_type::now());
+                destroy(c);
+
+                if (t) {
+                    if (next) {
+                        t->attempt++;
+                        start(std::move(t));
+                    }
+                    else if (stale && t->idempotent) {
+                        t->retried = true;
+                        t->written = 0;
+                        start(std::move(t));
+                    }
+                    else if (stale) {
+                        rest_response resp {restcl_status::Retryable,
+                                            "The kept-alive connection closed before the response; the request is not idempotent "
+                                            "and was not resent"};
+                        complete(std::move(t), resp);
+                    }
+                    else {
+                        fail(std::move(t), err, stage);
+                    }
+                }
+
+                // Room for another connection to the origin
+                if (bucket != nullptr) {
+                    if (auto next = nextWaiting(bucket); next) start(std::move(next));
+                }
+            }
+
+            void evictIdle() { pool.evict_idle(); }
+
+            /// @brief Fail every transaction with ECANCELED: those submitted but not started, those waiting and those in
+            /// progress. Later submissions fail in submit().
+            void shutdown()
+            {
+                {
+                    std::scoped_lock<std::mutex> l(submitLock);
+                    closed = true;
+                }
+                for (auto* t = takeSubmissions(); t != nullptr;) {
+                    auto owned = std::unique_ptr<transaction>(std::exchange(t, t->next));
+                    fail(std::move(owned), ECANCELED, "shutdown");
+                }
+
+                for (auto& [bucket, list] : waiting) {
+                    for (auto& t : list) fail(std::move(t), ECANCELED, "shutdown");
+                }
+                waiting.clear();
+                for (auto& [origin, list] : resolving) {
+                    for (auto& t : list) fail(std::move(t), ECANCELED, "shutdown");
+                }
+                resolving.clear();
+
+                std::vector<connection*> all {};
+                for (auto& [c, _] : connections) all.push_back(c);
+                for (auto* c : all) {
+                    if (c->active) c->active->retried = true;
+                    close(c, ECANCELED, "shutdown");
+                }
+            }
+        };
+
+
+        std::unique_ptr<event_loop> loop {};
+
+
+        /// @brief Prepare the transaction on the caller's thread so the loop thread only performs IO.
+        /// @param t Transaction whose request is encoded into the output buffer
+        void prepare(transaction& t)
+        {
+            auto& req = *t.request;
+
+            // First order - adjust the UserAgent
+            if (!req.headers().contains("User-Agent")) req.headers().set("User-Agent", UserAgent);
+            if (!SendDate) req.headers().erase("Date");
+            stampDeadline(req);
+
+            t.deadline = req.getDeadline();
+            t.timeouts = req.getTimeouts();
+            t.secure = req.uri.scheme == UriScheme::WebHttps;
+            t.host   = req.uri.authority.host;
+            t.port   = std::to_string(req.uri.authority.port);
+            pool_type::key_to(t.origin, req.uri.scheme, t.host, req.uri.authority.port);
+
+            auto method  = std::as_const(req)["request"].value("method", "");
+            t.idempotent = method == "GET" || method == "HEAD" || method == "PUT" || method == "DELETE" || method == "OPTIONS";
+            t.reader.parser.set_head_request(method == "HEAD");
+            t.reader.content.expect(req);
+
+            // This implementation always speaks HTTP/1.1 on the wire
+            req.setProtocol(HTTPProtocolVersion::Http11);
+            t.body = req.encode_head_to(t.out);
+        }
+
+    public:
+        EpollRESTClient(const EpollRESTClient&)            = delete;
+        EpollRESTClient& operator=(const EpollRESTClient&) = delete;
+
+        /// @brief Move constructor. The event loop (and its connections) is transferred to our instance.
+        EpollRESTClient(EpollRESTClient&& src) noexcept            = default;
+        EpollRESTClient& operator=(EpollRESTClient&& src) noexcept = default;
+
+
+        /// @brief Creates the Linux REST Client with given UserAgent string and starts the event loop
+        /// @param ua User agent string; defaults to `siddiqsoft.restcl_epoll/1.6 (Linux)`
+        /// @param poolOptions Limits for the keep-alive connection pool
+        EpollRESTClient(const std::string& ua = "siddiqsoft.restcl_epoll/1.6 (Linux)", const connection_pool_options& poolOptions = {})
+            : loop(std::make_unique<event_loop>(poolOptions))
+        {
+            UserAgent = ua;
+        }
+
+
+        /// @brief The typed send<T>() overloads of basic_restclient
+        using basic_restclient::send;
+
+
+        /// @brief Implements an asynchronous invocation of the send() method
+        /// @param req Request object
+        /// @param callback Invoked on the event loop thread once the response is available
+        void send(basic_request&& req, basic_callbacktype& callback)
+        {
+            submitOwned(std::move(req), [callback](basic_request&& q, basic_response&& r) { callback(q, r); });
+        }
+
+
+        /// @brief Implements an asynchronous invocation of the send() method
+        /// @param req Request object
+        /// @param callback Invoked on the event loop thread once the response is available
+        void send(basic_request&& req, basic_callbacktype&& callback)
+        {
+            submitOwned(std::move(req), [callback = std::move(callback)](basic_request&& q, basic_response&& r) { callback(q, r); });
+        }
+
+
+        /// @brief Implements a synchronous send of the request.
+        /// The calling thread waits for the event loop to complete the IO; must not be called from within a callback.
+        /// @param req Request object
+        /// @return Response object
+        [[nodiscard]] basic_response send(basic_request& req)
+        {
+            if (loop->onLoopThread()) {
+                return rest_response {ERRNO_BASE + EDEADLK, "Synchronous send() from within a callback would deadlock the event loop"};
+            }
+
+            rest_response         result {};
+            std::binary_semaphore done {0};
+
+            auto t     = loop->acquire();
+            t->request = &req;
+            prepare(*t);
+            // The request remains the caller's; only the response is taken
+            t->onComplete = [&result, &done](basic_request&&, basic_response&& r) {
+                static_cast<basic_response&>(result) = std::move(r);
+                done.release();
+            };
+            loop->submit(std::move(t));
+
+            done.acquire();
+            return result;
+        }
+
+    protected:
+        /// @brief The transaction owns the request and the response; both are moved into the callback
+        void dispatch(basic_request&& req, basic_movecallbacktype&& callback) override { submitOwned(std::move(req), std::move(callback)); }
+
+    private:
+        /// @brief Queue the request in a pooled transaction. Neither the transaction, the callback nor the queue allocate
+        /// once the pool is warm; encoding re-uses the buffers of the transaction.
+        void submitOwned(basic_request&& req, basic_movecallbacktype&& onComplete)
+        {
+            auto t = loop->acquire();
+            // The slot was emptied when the transaction was recycled
+            if (t->owned) *t->owned = std::move(req);
+            else
+                t->owned.emplace(std::move(req));
+            t->request = &*t->owned;
+            prepare(*t);
+            t->onComplete = std::move(onComplete);
+            loop->submit(std::move(t));
+        }
+    };
+} // namespace siddiqsoft
+
+#endif // __linux__
+
+#endif // !RESTCLEPOLL_HPP
@@ -0,0 +1,618 @@
+/*
+    restcl : Work-stealing executor for the asynchronous send()
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_EXECUTOR_HPP
+#define RESTCL_EXECUTOR_HPP
+
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "restcl.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief What submit() does when the bounded queue is full
+    enum class overflow_policy
+    {
+        Block,     // wait for room; submissions from within a callback (a worker thread) are admitted regardless
+        Reject,    // complete the new request at once with restcl_status::QueueFull
+        DropOldest // complete the oldest queued request with restcl_status::Dropped and queue the new one; as Block if none is queued
+    };
+
+
+    struct executor_options
+    {
+        unsigned        threads {0};  // 0 uses the number of hardware threads
+        size_t          capacity {0}; // requests queued but not yet started; 0 is unbounded
+        overflow_policy overflow {overflow_policy::Block};
+        /// @brief Share of the workers by request_priority: out of every 13 requests started while all lanes are busy, 8 are
+        /// High, 4 Normal and 1 Low. Every lane has a share so none starves. A weight of 0 is treated as 1.
+        std::array<unsigned, REQUEST_PRIORITY_LANES> laneWeights {8, 4, 1};
+    };
+
+
+    /// @brief Counters of a priority lane
+    struct lane_stats
+    {
+        size_t                   depth {0}; // queued, not yet started
+        uint64_t                 started {0};
+        uint64_t                 completed {0};
+        std::chrono::nanoseconds totalWait {0}; // from submit() until a worker started the request
+        std::chrono::nanoseconds maxWait {0};
+        std::chrono::nanoseconds totalLatency {0}; // from submit() until the callback returned
+        std::chrono::nanoseconds maxLatency {0};
+
+        std::chrono::nanoseconds averageWait() const { return started > 0 ? totalWait / static_cast<int64_t>(started) : std::chrono::nanoseconds {0}; }
+
+        std::chrono::nanoseconds averageLatency() const
+        {
+            return completed > 0 ? totalLatency / static_cast<int64_t>(completed) : std::chrono::nanoseconds {0};
+        }
+    };
+
+
+    /// @brief Counters of the executor; a snapshot (the counters are read individually)
+    struct executor_stats
+    {
+        size_t                   depth {0}; // queued, not yet started
+        size_t                   peakDepth {0};
+        uint64_t                 submitted {0};
+        uint64_t                 started {0};
+        uint64_t                 rejected {0};
+        uint64_t                 dropped {0};
+        uint64_t                 steals {0};  // taken from the queue of another worker
+        uint64_t                 expired {0};   // completed with restcl_status::Timeout instead of being sent
+        uint64_t                 cancelled {0}; // removed from the queue by their stop token
+        std::chrono::nanoseconds totalWait {0}; // from submit() until a worker started the request
+        std::chrono::nanoseconds maxWait {0};
+
+        /// @brief By request_priority
+        std::array<lane_stats, REQUEST_PRIORITY_LANES> lanes {};
+
+        std::chrono::nanoseconds averageWait() const { return started > 0 ? totalWait / static_cast<int64_t>(started) : std::chrono::nanoseconds {0}; }
+
+        const lane_stats& lane(request_priority p) const { return lanes[static_cast<size_t>(p)]; }
+    };
+
+
+    /// @brief Runs the synchronous send() of a client on a pool of worker threads; the asynchronous send() of a backend
+    /// which has no native asynchronous IO submits here.
+    ///
+    /// Each worker owns a queue. A request submitted from a worker thread (e.g. from within a callback) is queued on that
+    /// worker; any other thread spreads its requests over the queues round-robin so that submitters rarely meet on a lock.
+    /// An idle worker takes requests from the other queues (oldest first) so a slow request delays only the requests
+    /// behind it on the same queue until another worker steals them.
+    ///
+    /// The jobs are pooled and linked intrusively; a steady stream of submissions does not allocate.
+    /// Requests still queued when the executor is destroyed complete with restcl_status::Shutdown.
+    ///
+    /// The queue may be bounded (executor_options::capacity) so that a brownout of the server shows up as backpressure
+    /// instead of an ever growing backlog; the overflow_policy decides whether submit() waits, rejects the new request or
+    /// drops the oldest. Requests completed by the policy are completed on the submitting thread.
+    ///
+    /// Each queue holds a lane per request_priority. Every worker starts requests from the lanes by weighted round-robin
+    /// (executor_options::laneWeights) so that latency-critical requests overtake bulk traffic without starving it; a lane
+    /// without requests yields its turn. DropOldest drops from the lowest priority lane first.
+    ///
+    /// Within a lane the requests are ordered by deadline (earliest first; those without one in submission order). A request
+    /// whose deadline has passed by the time a worker takes it completes with restcl_status::Timeout and is not sent.
+    ///
+    /// A queued request whose stop token is stopped is removed from the queue and completes with restcl_status::Cancelled
+    /// on the thread which requested the stop; once started, the client's send() observes the token.
+    class async_executor
+    {
+        /// @brief Completed jobs kept for re-use
+        static const size_t MAX_POOLED_JOBS {256};
+
+        using clock_type = std::chrono::steady_clock;
+
+        struct job;
+
+        /// @brief Guarded by the lock of the queue the job is assigned to
+        enum class job_state : uint8_t
+        {
+            Idle,
+            Queued,
+            Taken,
+            Cancelled // before it was queued
+        };
+
+        /// @brief The stop callback of a job
+        struct canceller
+        {
+            async_executor* executor;
+            job*            j;
+
+            void operator()() const noexcept { executor->cancel(j); }
+        };
+
+        struct job
+        {
+            std::optional<basic_request>                  request {};
+            basic_movecallbacktype                        callback {};
+            clock_type::time_point                        enqueued {};
+            clock_type::time_point                        deadline {};
+            size_t                                        lane {0};
+            size_t                                        queue {0};
+            job_state                                     state {job_state::Idle};
+            std::optional<std::stop_callback<canceller>> onCancel {};
+            job*                                          next {nullptr};
+        };
+
+        struct job_list
+        {
+            job* head {nullptr};
+            job* tail {nullptr};
+        };
+
+        /// @brief A worker's queue; aligned so that neighbouring queues do not share a cache line
+        struct alignas(64) worker_queue
+        {
+            std::mutex                                   lock {};
+            std::array<job_list, REQUEST_PRIORITY_LANES> lanes {};
+        };
+
+        /// @brief Turns left to each lane in the current round of a worker
+        using lane_credits = std::array<unsigned, REQUEST_PRIORITY_LANES>;
+
+        struct lane_counters
+        {
+            std::atomic<size_t>   depth {0};
+            std::atomic<uint64_t> started {0};
+            std::atomic<uint64_t> completed {0};
+            std::atomic<uint64_t> totalWaitNs {0};
+            std::atomic<uint64_t> maxWaitNs {0};
+            std::atomic<uint64_t> totalLatencyNs {0};
+            std::atomic<uint64_t> maxLatencyNs {0};
+        };
+
+    public:
+        /// @param client Performs the IO via its synchronous send(); must outlive the executor
+        /// @param opts Number of workers and the bounds of the queue
+        explicit async_executor(basic_restclient& client, const executor_options& opts = {})
+            : client(client)
+            , options(opts)
+        {
+            auto threads = options.threads > 0 ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+            for (auto& w : options.laneWeights) w = std::max(1u, w);
+            queues = std::make_unique<worker_queue[]>(threads);
+            count  = threads;
+            workers.reserve(threads);
+            for (size_t i = 0; i < count; i++) workers.emplace_back([this, i](std::stop_token st) { run(i, st); });
+        }
+
+        /// @param client Performs the IO via its synchronous send(); must outlive the executor
+        /// @param threads Number of workers; 0 uses the number of hardware threads
+        async_executor(basic_restclient& client, unsigned threads)
+            : async_executor(client, executor_options {.threads = threads})
+        {
+        }
+
+        async_executor(const async_executor&)            = delete;
+        async_executor& operator=(const async_executor&) = delete;
+
+        ~async_executor()
+        {
+            for (auto& w : workers) w.request_stop();
+            signal.fetch_add(1);
+            signal.notify_all();
+            workers.clear();
+
+            for (size_t i = 0; i < count; i++) {
+                for (size_t lane = 0; lane < REQUEST_PRIORITY_LANES; lane++) {
+                    while (auto* j = pop(queues[i], lane)) {
+                        depth.fetch_sub(1, std::memory_order_relaxed);
+                        lanes[lane].depth.fetch_sub(1, std::memory_order_relaxed);
+                        complete(j, rest_response {restcl_status::Shutdown, "The executor was destroyed before the request was sent"});
+                    }
+                }
+            }
+            for (auto* j = pooled; j != nullptr;) delete std::exchange(j, j->next);
+        }
+
+
+        /// @brief Queue the request in the lane of its priority; the callback is invoked on a worker thread with the request
+        /// and the response. If the queue is full the overflow_policy applies.
+        void submit(basic_request&& req, basic_movecallbacktype&& callback)
+        {
+            auto* j = acquire();
+            j->lane     = std::min(static_cast<size_t>(req.getPriority()), REQUEST_PRIORITY_LANES - 1);
+            j->deadline = req.getDeadline();
+            j->request.emplace(std::move(req));
+            j->callback = std::move(callback);
+            j->enqueued = clock_type::now();
+            submitted.fetch_add(1, std::memory_order_relaxed);
+            if (!admit(j)) return;
+
+            j->queue = current == this ? currentIndex : nextQueue.fetch_add(1, std::memory_order_relaxed) % count;
+            // A stop requested before the job is queued marks the job; push() then declines it
+            if (auto& token = j->request->getStopToken(); token.stop_possible()) j->onCancel.emplace(token, canceller {this, j});
+            lanes[j->lane].depth.fetch_add(1, std::memory_order_relaxed);
+            if (!push(queues[j->queue], j)) {
+                release();
+                lanes[j->lane].depth.fetch_sub(1, std::memory_order_relaxed);
+                cancelled.fetch_add(1, std::memory_order_relaxed);
+                return complete(j, rest_response {restcl_status::Cancelled, "The request was cancelled"});
+            }
+
+            signal.fetch_add(1, std::memory_order_release);
+            signal.notify_one();
+        }
+
+
+        /// @brief Number of worker threads
+        size_t concurrency() const { return count; }
+
+        const executor_options& limits() const { return options; }
+
+        executor_stats stats() const
+        {
+            executor_stats r {.depth     = depth.load(std::memory_order_relaxed),
+                              .peakDepth = peakDepth.load(std::memory_order_relaxed),
+                              .submitted = submitted.load(std::memory_order_relaxed),
+                              .rejected  = rejected.load(std::memory_order_relaxed),
+                              .dropped   = dropped.load(std::memory_order_relaxed),
+                              .steals    = stolen.load(std::memory_order_relaxed),
+                              .expired   = expired.load(std::memory_order_relaxed),
+                              .cancelled = cancelled.load(std::memory_order_relaxed)};
+
+            for (size_t i = 0; i < REQUEST_PRIORITY_LANES; i++) {
+                auto& c = lanes[i];
+                auto& l = r.lanes[i];
+                l.depth        = c.depth.load(std::memory_order_relaxed);
+                l.started      = c.started.load(std::memory_order_relaxed);
+                l.completed    = c.completed.load(std::memory_order_relaxed);
+                l.totalWait    = std::chrono::nanoseconds(c.totalWaitNs.load(std::memory_order_relaxed));
+                l.maxWait      = std::chrono::nanoseconds(c.maxWaitNs.load(std::memory_order_relaxed));
+                l.totalLatency = std::chrono::nanoseconds(c.totalLatencyNs.load(std::memory_order_relaxed));
+                l.maxLatency   = std::chrono::nanoseconds(c.maxLatencyNs.load(std::memory_order_relaxed));
+
+                r.started += l.started;
+                r.totalWait += l.totalWait;
+                r.maxWait = std::max(r.maxWait, l.maxWait);
+            }
+            return r;
+        }
+
+    private:
+        void run(size_t self, std::stop_token st)
+        {
+            current      = this;
+            currentIndex = self;
+
+            lane_credits credits = options.laneWeights;
+            while (!st.stop_requested()) {
+                // A submission after the scan changes the signal so the wait returns at once
+                auto seen = signal.load(std::memory_order_acquire);
+                if (auto* j = take(self, credits); j != nullptr) {
+                    execute(j);
+                    continue;
+                }
+                signal.wait(seen);
+            }
+        }
+
+        /// @brief Reserve room in the queue for the job
+        /// @return false if the job has been completed by the overflow policy
+        bool admit(job* j)
+        {
+            auto d     = depth.load(std::memory_order_relaxed);
+            bool force = false;
+            while (true) {
+                if (force || options.capacity == 0 || d < options.capacity ||
+                    (options.overflow == overflow_policy::Block && current == this))
+                {
+                    if (!depth.compare_exchange_weak(d, d + 1, std::memory_order_acq_rel)) continue;
+                    for (auto peak = peakDepth.load(std::memory_order_relaxed);
+                         d + 1 > peak && !peakDepth.compare_exchange_weak(peak, d + 1, std::memory_order_relaxed);)
+                    {
+                    }
+                    return true;
+                }
+
+                switch (options.overflow) {
+                    case overflow_policy::Reject:
+                        rejected.fetch_add(1, std::memory_order_relaxed);
+                        complete(j, rest_response {restcl_status::QueueFull, "The request queue is full"});
+                        return false;
+
+                    case overflow_policy::DropOldest:
+                        // The room of the dropped job is handed to the new job
+                        if (auto* oldest = removeOldest(); oldest != nullptr) {
+                            dropped.fetch_add(1, std::memory_order_relaxed);
+                            complete(oldest, rest_response {restcl_status::Dropped, "Dropped from the full request queue"});
+                            return true;
+                        }
+                        // Nothing to drop while every job counted in the queue is being pushed or started: a worker thread
+                        // is admitted regardless (as with Block) and any other thread waits for room instead of spinning
+                        if (current == this) {
+                            force = true;
+                            break;
+                        }
+                        [[fallthrough]];
+
+                    case overflow_policy::Block:
+                        blocked.fetch_add(1);
+                        depth.wait(d);
+                        blocked.fetch_sub(1, std::memory_order_relaxed);
+                        break;
+                }
+                d = depth.load(std::memory_order_relaxed);
+            }
+        }
+
+        /// @brief The next job by weighted round-robin over the lanes: a lane with turns left is served from the worker's
+        /// own queue or else stolen from another queue. Once the lanes with turns left are empty a new round begins.
+        job* take(size_t self, lane_credits& credits)
+        {
+            job* j = nullptr;
+            for (int round = 0; j == nullptr && round < 2; round++) {
+                for (size_t lane = 0; j == nullptr && lane < REQUEST_PRIORITY_LANES; lane++) {
+                    if (credits[lane] == 0) continue;
+                    if (j = takeLane(self, lane); j != nullptr) credits[lane]--;
+                }
+                if (j == nullptr) credits = options.laneWeights;
+            }
+            if (j == nullptr) return nullptr;
+
+            release();
+            auto& c = lanes[j->lane];
+            c.depth.fetch_sub(1, std::memory_order_relaxed);
+            c.started.fetch_add(1, std::memory_order_relaxed);
+            record(c.totalWaitNs, c.maxWaitNs, j->enqueued);
+            return j;
+        }
+
+        /// @brief Give back the room of a job which left the queue
+        void release()
+        {
+            // Sequentially consistent with the submitter which counts itself in blocked before waiting on depth
+            depth.fetch_sub(1);
+            if (blocked.load() > 0) depth.notify_all();
+        }
+
+        /// @brief Invoked by the stop callback of the job on the thread which requested the stop. A queued job is removed
+        /// and completed here; a job which is not yet queued is marked for push() to decline; a started job is left to
+        /// the client.
+        void cancel(job* j)
+        {
+            {
+                std::scoped_lock<std::mutex> l(queues[j->queue].lock);
+                if (j->state == job_state::Idle) {
+                    j->state = job_state::Cancelled;
+                    return;
+                }
+                if (j->state != job_state::Queued) return;
+
+                auto& list = queues[j->queue].lanes[j->lane];
+                job*  prev = nullptr;
+                for (auto* p = list.head; p != j; p = p->next) prev = p;
+                (prev != nullptr ? prev->next : list.head) = j->next;
+                if (list.tail == j) list.tail = prev;
+                j->state = job_state::Taken;
+            }
+
+            release();
+            lanes[j->lane].depth.fetch_sub(1, std::memory_order_relaxed);
+            cancelled.fetch_add(1, std::memory_order_relaxed);
+            // Destroys the stop callback which is running; permitted on the invoking thread
+            complete(j, rest_response {restcl_status::Cancelled, "The request was cancelled"});
+        }
+
+        job* takeLane(size_t self, size_t lane)
+        {
+            if (auto* j = pop(queues[self], lane); j != nullptr) return j;
+            for (size_t k = 1; k < count; k++) {
+                if (auto* j = pop(queues[(self + k) % count], lane); j != nullptr) {
+                    stolen.fetch_add(1, std::memory_order_relaxed);
+                    return j;
+                }
+            }
+            return nullptr;
+        }
+
+        /// @brief Add the time since the start to the total and the maximum
+        static void record(std::atomic<uint64_t>& total, std::atomic<uint64_t>& maximum, clock_type::time_point start)
+        {
+            auto ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+            total.fetch_add(ns, std::memory_order_relaxed);
+            for (auto m = maximum.load(std::memory_order_relaxed); ns > m && !maximum.compare_exchange_weak(m, ns);) {
+            }
+        }
+
+        /// @brief Remove the job which was submitted first among the heads of the lowest priority lane that has a job.
+        /// With deadlines the heads are the requests nearest to expiry, the least likely to be of use.
+        job* removeOldest()
+        {
+            for (size_t lane = REQUEST_PRIORITY_LANES; lane-- > 0;) {
+                size_t                 victim = count;
+                clock_type::time_point oldest = clock_type::time_point::max();
+                for (size_t i = 0; i < count; i++) {
+                    std::scoped_lock<std::mutex> l(queues[i].lock);
+                    if (auto* head = queues[i].lanes[lane].head; head != nullptr && head->enqueued < oldest) {
+                        oldest = head->enqueued;
+                        victim = i;
+                    }
+                }
+                if (victim < count) {
+                    if (auto* j = pop(queues[victim], lane); j != nullptr) {
+                        lanes[lane].depth.fetch_sub(1, std::memory_order_relaxed);
+                        return j;
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        void execute(job* j)
+        {
+            if (j->request->expired()) {
+                expired.fetch_add(1, std::memory_order_relaxed);
+                return complete(j, rest_response {restcl_status::Timeout, "The deadline passed before the request was sent"});
+            }
+
+            try {
+                basic_response resp = client.send(*j->request);
+                complete(j, std::move(resp));
+            }
+            catch (const std::exception& e) {
+                complete(j, rest_response {restcl_status::Exception, e.what()});
+            }
+        }
+
+        void complete(job* j, basic_response&& resp)
+        {
+            try {
+                if (j->callback) j->callback(std::move(*j->request), std::move(resp));
+            }
+            catch (const std::exception&) {
+            }
+            auto& c = lanes[j->lane];
+            c.completed.fetch_add(1, std::memory_order_relaxed);
+            record(c.totalLatencyNs, c.maxLatencyNs, j->enqueued);
+            recycle(j);
+        }
+
+        /// @brief Insert by deadline. Requests without a deadline (and those submitted in deadline order) are appended.
+        /// @return false if the job was cancelled before it could be queued
+        static bool push(worker_queue& q, job* j)
+        {
+            j->next = nullptr;
+            std::scoped_lock<std::mutex> l(q.lock);
+            if (j->state == job_state::Cancelled) return false;
+            j->state = job_state::Queued;
+
+            auto& list = q.lanes[j->lane];
+            if (list.tail == nullptr) {
+                list.head = list.tail = j;
+            }
+            else if (list.tail->deadline <= j->deadline) {
+                list.tail->next = j;
+                list.tail       = j;
+            }
+            else {
+                // Before the first with a later deadline; the tail has one so the walk ends before it
+                job** link = &list.head;
+                while ((*link)->deadline <= j->deadline) link = &(*link)->next;
+                j->next = *link;
+                *link   = j;
+            }
+            return true;
+        }
+
+        static job* pop(worker_queue& q, size_t lane)
+        {
+            std::scoped_lock<std::mutex> l(q.lock);
+            auto&                        list = q.lanes[lane];
+            auto*                        j    = list.head;
+            if (j != nullptr) {
+                list.head = j->next;
+                if (list.head == nullptr) list.tail = nullptr;
+                j->state = job_state::Taken;
+            }
+            return j;
+        }
+
+        job* acquire()
+        {
+            {
+                std::scoped_lock<std::mutex> l(poolLock);
+                if (pooled != nullptr) {
+                    pooledCount--;
+                    return std::exchange(pooled, pooled->next);
+                }
+            }
+            return new job {};
+        }
+
+        void recycle(job* j)
+        {
+            // Waits for the stop callback if it runs on another thread; it finds the job taken
+            j->onCancel.reset();
+            j->state = job_state::Idle;
+            j->request.reset();
+            j->callback = nullptr;
+
+            {
+                std::scoped_lock<std::mutex> l(poolLock);
+                if (pooledCount < MAX_POOLED_JOBS) {
+                    j->next = pooled;
+                    pooled  = j;
+                    pooledCount++;
+                    return;
+                }
+            }
+            delete j;
+        }
+
+    private:
+        basic_restclient&               client;
+        executor_options                options {};
+        std::unique_ptr<worker_queue[]> queues {};
+        size_t                          count {0};
+        std::atomic<size_t>             nextQueue {0};
+        std::atomic<uint32_t>           signal {0}; // changes on every submission and on shutdown
+        std::atomic<size_t>             depth {0};
+        std::atomic<uint32_t>           blocked {0}; // submitters waiting for room
+        std::atomic<size_t>             peakDepth {0};
+        std::atomic<uint64_t>           submitted {0};
+        std::atomic<uint64_t>           rejected {0};
+        std::atomic<uint64_t>           dropped {0};
+        std::atomic<uint64_t>           stolen {0};
+        std::atomic<uint64_t>           expired {0};
+        std::atomic<uint64_t>           cancelled {0};
+        std::array<lane_counters, REQUEST_PRIORITY_LANES> lanes {};
+        std::mutex                      poolLock {};
+        job*                            pooled {nullptr};
+        size_t                          pooledCount {0};
+        std::vector<std::jthread>       workers {}; // declared last: the workers stop before the members they use
+
+        static inline thread_local const async_executor* current {nullptr};
+        static inline thread_local size_t                currentIndex {0};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_EXECUTOR_HPP
@@ -0,0 +1,696 @@
+/*
+    restcl : Flat header store for the request and response
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_HEADERS_HPP
+#define RESTCL_HEADERS_HPP
+
+
+#include <string>
+#include <string_view>
+#include <array>
+#include <vector>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <utility>
+#include <memory>
+#include <optional>
+
+
+#include "nlohmann/json.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Case-insensitive comparison of header names (ASCII)
+    inline bool header_name_equals(std::string_view a, std::string_view b) noexcept
+    {
+        if (a.length() != b.length()) return false;
+        for (size_t i = 0; i < a.length(); i++) {
+            auto ca = a[i], cb = b[i];
+            if (ca >= 'A' && ca <= 'Z') ca += 'a' - 'A';
+            if (cb >= 'A' && cb <= 'Z') cb += 'a' - 'A';
+            if (ca != cb) return false;
+        }
+        return true;
+    }
+
+
+    /// @brief Headers which the library (and most callers) consult on every response; their lookup in a received block is a
+    /// slot read rather than a scan
+    enum class known_header : uint8_t
+    {
+        ContentLength,
+        ContentType,
+        ETag,
+        RetryAfter,
+        Other
+    };
+
+    /// @brief Wire names indexed by known_header
+    inline constexpr std::array<std::string_view, 4> KnownHeaderNames {"Content-Length", "Content-Type", "ETag", "Retry-After"};
+
+    constexpr std::string_view to_string_view(known_header h) { return KnownHeaderNames[static_cast<size_t>(h)]; }
+
+    /// @brief Classify the header name (case-insensitive). The known names differ in length so the length selects the only
+    /// candidate and a single comparison confirms it.
+    inline known_header to_known_header(std::string_view name) noexcept
+    {
+        known_header h {known_header::Other};
+        switch (name.length()) {
+            case 14: h = known_header::ContentLength; break;
+            case 12: h = known_header::ContentType; break;
+            case 4: h = known_header::ETag; break;
+            case 11: h = known_header::RetryAfter; break;
+            default: return known_header::Other;
+        }
+        return header_name_equals(name, to_string_view(h)) ? h : known_header::Other;
+    }
+
+
+    /// @brief Flat, insertion ordered store of HTTP headers with case-insensitive lookup.
+    /// The first INLINE_CAPACITY headers are held inline (the common request has fewer); the rest spill into a vector.
+    /// Values are kept in their wire form along with their json type so that the json view round-trips numbers and booleans.
+    ///
+    /// A json object view is available on demand via json(). The mutable view becomes the authoritative copy until the next
+    /// typed access, which folds any changes made through the view back into the store.
+    ///
+    /// A store may be layered over a shared, immutable base (see share()) which is copied only when one of its headers is
+    /// erased; headers that are added or replaced are kept in the store itself.
+    ///
+    /// Headers added via receive() are kept as received in a single block of "Name: value\r\n" lines. Each line is indexed
+    /// (offsets, no copies) as it is received and the known headers are found via their slot. The lines of a repeated
+    /// header are chained and their values folded into a side buffer. The index and the buffers keep their capacity across
+    /// clear() so a store re-used for each response does not allocate. The block is converted into entries only when the
+    /// store is modified; the const members only read it.
+    /// @note The store is not thread-safe; as with the request itself a single thread is expected to use it at a time.
+    class http_headers
+    {
+    public:
+        static constexpr size_t INLINE_CAPACITY {12};
+
+        /// @brief The json type of the value; the wire form is always text
+        enum class value_kind : uint8_t
+        {
+            String,
+            Signed,
+            Unsigned,
+            Boolean,
+            Json
+        };
+
+        struct entry
+        {
+            std::string name {};
+            std::string value {};
+            value_kind  kind {value_kind::String};
+        };
+
+        /// @brief A header as found by find(); the views are valid until the store is modified
+        struct header_view
+        {
+            std::string_view name {};
+            std::string_view value {};
+            value_kind       kind {value_kind::String};
+        };
+
+    private:
+        static constexpr uint32_t NO_LINE {UINT32_MAX};
+
+        /// @brief A received header: offsets into the block; the value follows the name and ": ".
+        /// The first line of a repeated header links the later ones and refers to the folded value.
+        struct received_line
+        {
+            uint32_t offset {0};
+            uint32_t nameLength {0};
+            uint32_t valueLength {0};
+            uint32_t next {NO_LINE};       // the next line with the same name
+            uint32_t foldOffset {NO_LINE}; // the folded value within folds
+            uint32_t foldLength {0};
+            bool     repeat {false}; // a later line of a repeated header; its value is part of the first line's
+        };
+
+    public:
+        http_headers() = default;
+
+        /// @brief Construct from a json object of name/value pairs
+        explicit http_headers(const nlohmann::json& src) { assign(src); }
+
+        /// @brief Construct an empty store layered over the shared headers
+        /// @param shared Obtained from share()
+        explicit http_headers(std::shared_ptr<const http_headers> shared)
+            : base(std::move(shared))
+        {
+        }
+
+        /// @brief Freeze the headers so that they may be shared (read-only) by any number of stores and threads.
+        /// The wire form and the json view are computed once here.
+        static std::shared_ptr<const http_headers> share(http_headers src)
+        {
+            src.sync();
+            src.unblock();
+            if (src.base) src.detach();
+            src.wire.clear();
+            src.for_each([&](std::string_view k, std::string_view v) { src.wire.append(k).append(": ").append(v).append("\r\n"); });
+            src.json();
+            src.viewLive = false;
+            return std::make_shared<const http_headers>(std::move(src));
+        }
+
+        /// @brief Replace the contents with the json object of name/value pairs
+        http_headers& assign(const nlohmann::json& src)
+        {
+            viewLive = false;
+            assignFrom(src);
+            viewFresh = false;
+            return *this;
+        }
+
+
+        /// @brief Number of headers
+        size_t size() const
+        {
+            sync();
+            if (!block.empty()) return distinctCount;
+            return base ? count + base->count - shadowed() : count;
+        }
+
+        bool empty() const { return size() == 0; }
+
+        /// @brief Case-insensitive check for the header
+        bool contains(std::string_view name) const
+        {
+            sync();
+            if (!block.empty()) return lineOf(name) != nullptr;
+            return findEntry(name) != nullptr;
+        }
+
+        bool contains(known_header h) const { return contains(to_string_view(h)); }
+
+        /// @brief Case-insensitive lookup
+        /// @return The header or nullopt if absent; a repeated received header has its folded value
+        std::optional<header_view> find(std::string_view name) const
+        {
+            sync();
+            if (!block.empty()) {
+                if (auto* l = lineOf(name); l != nullptr) return header_view {nameOf(*l), valueOf(*l)};
+                return std::nullopt;
+            }
+            if (auto* e = findEntry(name); e != nullptr) return header_view {e->name, e->value, e->kind};
+            return std::nullopt;
+        }
+
+        /// @brief The wire value of the header
+        /// @param name Case-insensitive header name
+        /// @param def Returned if the header is absent
+        /// @return View valid until the store is modified
+        std::string_view value(std::string_view name, std::string_view def = {}) const
+        {
+            sync();
+            if (!block.empty()) {
+                auto* l = lineOf(name);
+                return l != nullptr ? valueOf(*l) : def;
+            }
+            auto* e = findEntry(name);
+            return e != nullptr ? std::string_view(e->value) : def;
+        }
+
+        /// @brief The wire value of the known header; a slot read for the received block
+        std::string_view value(known_header h, std::string_view def = {}) const
+        {
+            sync();
+            if (!block.empty()) {
+                auto* l = lineOf(h);
+                return l != nullptr ? valueOf(*l) : def;
+            }
+            return value(to_string_view(h), def);
+        }
+
+
+        /// @brief Add a header as received; the bytes are appended to the received block and indexed without building an
+        /// entry. Falls back to append() if the store holds other headers.
+        http_headers& receive(std::string_view name, std::string_view value)
+        {
+            sync();
+            if (count > 0 || base) return append(name, value);
+            if (block.empty()) {
+                lines.clear();
+                folds.clear();
+                distinctCount = 0;
+                known.fill(NO_LINE);
+            }
+            auto offset = block.length();
+            block.append(name).append(": ").append(value).append("\r\n");
+            indexLine(offset);
+            viewFresh = false;
+            return *this;
+        }
+
+
+        /// @brief Add or replace the header (case-insensitive match on the name; the existing spelling is retained)
+        http_headers& set(std::string_view name, std::string_view value) { return put(name, value, value_kind::String); }
+        http_headers& set(std::string_view name, const std::string& value) { return set(name, std::string_view(value)); }
+        http_headers& set(std::string_view name, const char* value) { return set(name, std::string_view(value)); }
+
+        template <class T>
+            requires std::integral<T>
+        http_headers& set(std::string_view name, T value)
+        {
+            if constexpr (std::same_as<T, bool>) {
+                return put(name, value ? "true" : "false", value_kind::Boolean);
+            }
+            else {
+                char number[24];
+                auto [end, ec] = std::to_chars(number, number + sizeof(number), value);
+                return put(name,
+                           std::string_view(number, end - number),
+                           std::is_signed_v<T> ? value_kind::Signed : value_kind::Unsigned);
+            }
+        }
+
+        /// @brief Add or replace the header from a json value (strings, numbers and booleans keep their type)
+        http_headers& set(std::string_view name, const nlohmann::json& value)
+        {
+            if (value.is_string()) return set(name, value.get_ref<const std::string&>());
+            if (value.is_boolean()) return set(name, value.get<bool>());
+            if (value.is_number_unsigned()) return set(name, value.get<uint64_t>());
+            if (value.is_number_integer()) return set(name, value.get<int64_t>());
+            return put(name, value.dump(), value_kind::Json);
+        }
+
+        /// @brief Add the header; a repeated header is folded into a comma separated list (RFC 7230 section 3.2.2)
+        http_headers& append(std::string_view name, std::string_view value)
+        {
+            sync();
+            unblock();
+            viewFresh = false;
+            if (auto* e = findMutable(name); e != nullptr) {
+                e->value.append(", ").append(value);
+                e->kind = value_kind::String;
+            }
+            else if (auto* b = base ? base->findMutable(name) : nullptr; b != nullptr) {
+                push(b->name, b->value, value_kind::String);
+                at(count - 1).value.append(", ").append(value);
+            }
+            else {
+                push(name, value, value_kind::String);
+            }
+            return *this;
+        }
+
+        /// @brief Remove the header
+        /// @return true if the header was present
+        bool erase(std::string_view name)
+        {
+            sync();
+            unblock();
+            if (base && base->findMutable(name) != nullptr) detach();
+            for (size_t i = 0; i < count; i++) {
+                if (header_name_equals(at(i).name, name)) {
+                    for (size_t j = i + 1; j < count; j++) std::swap(at(j - 1), at(j));
+                    pop();
+                    viewFresh = false;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /// @brief Remove all headers; the inline storage retains its capacity
+        void clear()
+        {
+            viewLive = false;
+            base.reset();
+            block.clear();
+            while (count > 0) pop();
+            viewFresh = false;
+        }
+
+
+        /// @brief Invokes the callable with the name and the wire value of each header in insertion order
+        /// @param fn Callable accepting (std::string_view name, std::string_view value)
+        template <class F>
+        void for_each(F&& fn) const
+        {
+            sync();
+            if (!block.empty()) {
+                for (auto& l : lines) {
+                    if (!l.repeat) fn(nameOf(l), valueOf(l));
+                }
+                return;
+            }
+            each_entry([&](const entry& e) { fn(std::string_view(e.name), std::string_view(e.value)); });
+        }
+
+        /// @brief Invokes the callable with consecutive parts of the wire form ("Name: value\r\n" for each header).
+        /// The shared base and the received block are emitted as a single part unless one of the base headers has been replaced.
+        /// @param emit Callable accepting (std::string_view part)
+        template <class F>
+        void for_each_wire(F&& emit) const
+        {
+            sync();
+            if (!block.empty()) {
+                emit(std::string_view(block));
+                return;
+            }
+            auto single = [&](const entry& e) {
+                emit(std::string_view(e.name));
+                emit(std::string_view(": "));
+                emit(std::string_view(e.value));
+                emit(std::string_view("\r\n"));
+            };
+
+            if (base && shadowed() == 0) {
+                emit(std::string_view(base->wire));
+                for (size_t i = 0; i < count; i++) single(at(i));
+            }
+            else {
+                each_entry(single);
+            }
+        }
+
+
+        /// @brief Json object view of the headers
+        /// @return Snapshot valid until the store is modified
+        const nlohmann::json& json() const
+        {
+            if (!viewLive && !viewFresh) {
+                view = nlohmann::json::object();
+                if (!block.empty()) {
+                    for (auto& l : lines) {
+                        if (!l.repeat) view[std::string(nameOf(l))] = valueOf(l);
+                    }
+                }
+                else {
+                    each_entry([&](const entry& e) { view[e.name] = toJson(e); });
+                }
+                viewFresh = true;
+            }
+            return view;
+        }
+
+        /// @brief Mutable json object view of the headers. Changes made via the view are folded back into the store on the
+        /// next typed access; do not retain the reference across typed access.
+        nlohmann::json& json()
+        {
+            std::as_const(*this).json();
+            viewLive = true;
+            return view;
+        }
+
+
+        friend void to_json(nlohmann::json& dest, const http_headers& src) { dest = src.json(); }
+        friend void from_json(const nlohmann::json& src, http_headers& dest) { dest.assign(src); }
+
+    private:
+        entry& at(size_t i) const { return i < INLINE_CAPACITY ? fixed[i] : overflow[i - INLINE_CAPACITY]; }
+
+        /// @brief Visit the effective entries: the base (with replaced values) followed by the headers added to the store
+        template <class F>
+        void each_entry(F&& fn) const
+        {
+            if (base) {
+                for (size_t i = 0; i < base->count; i++) {
+                    const auto& b = base->at(i);
+                    auto*       e = findMutable(b.name);
+                    fn(e != nullptr ? *e : b);
+                }
+            }
+            for (size_t i = 0; i < count; i++) {
+                if (const auto& e = at(i); !base || base->findMutable(e.name) == nullptr) fn(e);
+            }
+        }
+
+        /// @brief Number of entries of the store which replace a header of the base
+        size_t shadowed() const
+        {
+            size_t n = 0;
+            for (size_t i = 0; i < count; i++) {
+                if (base->findMutable(at(i).name) != nullptr) n++;
+            }
+            return n;
+        }
+
+        /// @brief Copy the effective headers into the store and drop the base
+        void detach() const
+        {
+            std::vector<entry> merged;
+            merged.reserve(count + base->count);
+            each_entry([&](const entry& e) { merged.push_back(e); });
+            base.reset();
+            while (count > 0) pop();
+            for (auto& e : merged) push(e.name, e.value, e.kind);
+        }
+
+        /// @brief The entry of the store or else of the base
+        const entry* findEntry(std::string_view name) const
+        {
+            if (auto* e = findMutable(name); e != nullptr) return e;
+            return base ? base->findMutable(name) : nullptr;
+        }
+
+        entry* findMutable(std::string_view name) const
+        {
+            for (size_t i = 0; i < count; i++) {
+                if (auto& e = at(i); header_name_equals(e.name, name)) return &e;
+            }
+            return nullptr;
+        }
+
+        http_headers& put(std::string_view name, std::string_view value, value_kind kind)
+        {
+            sync();
+            unblock();
+            viewFresh = false;
+            if (auto* e = findMutable(name); e != nullptr) {
+                e->value.assign(value);
+                e->kind = kind;
+            }
+            else {
+                push(name, value, kind);
+            }
+            return *this;
+        }
+
+        void push(std::string_view name, std::string_view value, value_kind kind) const
+        {
+            if (count < INLINE_CAPACITY) {
+                auto& e = fixed[count];
+                e.name.assign(name);
+                e.value.assign(value);
+                e.kind = kind;
+            }
+            else {
+                overflow.push_back({std::string(name), std::string(value), kind});
+            }
+            count++;
+        }
+
+        void pop() const
+        {
+            if (count > INLINE_CAPACITY) {
+                overflow.pop_back();
+            }
+            else {
+                // Retain the capacity of the inline strings for re-use
+                fixed[count - 1].name.clear();
+                fixed[count - 1].value.clear();
+            }
+            count--;
+        }
+
+        void assignFrom(const nlohmann::json& src) const
+        {
+            base.reset();
+            block.clear();
+            while (count > 0) pop();
+            if (!src.is_object()) return;
+
+            for (auto it = src.cbegin(); it != src.cend(); ++it) {
+                const auto& v = it.value();
+                if (v.is_string()) push(it.key(), v.get_ref<const std::string&>(), value_kind::String);
+                else if (v.is_boolean())
+                    push(it.key(), v.get<bool>() ? "true" : "false", value_kind::Boolean);
+                else if (v.is_number_unsigned())
+                    push(it.key(), std::to_string(v.get<uint64_t>()), value_kind::Unsigned);
+                else if (v.is_number_integer())
+                    push(it.key(), std::to_string(v.get<int64_t>()), value_kind::Signed);
+                else
+                    push(it.key(), v.dump(), value_kind::Json);
+            }
+        }
+
+        /// @brief Fold the changes made through the mutable json view back into the store
+        void sync() const
+        {
+            if (viewLive) {
+                viewLive = false;
+                assignFrom(view);
+                viewFresh = true;
+            }
+        }
+
+        /// @brief The received line starting at the offset
+        static received_line lineAt(std::string_view raw, size_t offset)
+        {
+            auto colon = raw.find(':', offset);
+            auto eol   = raw.find("\r\n", colon);
+            return {static_cast<uint32_t>(offset), static_cast<uint32_t>(colon - offset), static_cast<uint32_t>(eol - colon - 2)};
+        }
+
+        static size_t nextLine(const received_line& l) { return size_t {l.offset} + l.nameLength + 2 + l.valueLength + 2; }
+
+        std::string_view nameOf(const received_line& l) const { return std::string_view(block).substr(l.offset, l.nameLength); }
+
+        /// @brief The value of the line; the folded value for the first line of a repeated header
+        std::string_view valueOf(const received_line& l) const
+        {
+            if (l.foldOffset != NO_LINE) return std::string_view(folds).substr(l.foldOffset, l.foldLength);
+            return std::string_view(block).substr(size_t {l.offset} + l.nameLength + 2, l.valueLength);
+        }
+
+        std::string_view rawValueOf(const received_line& l) const
+        {
+            return std::string_view(block).substr(size_t {l.offset} + l.nameLength + 2, l.valueLength);
+        }
+
+        const received_line* lineOf(known_header h) const
+        {
+            auto i = known[static_cast<size_t>(h)];
+            return i < lines.size() ? &lines[i] : nullptr;
+        }
+
+        /// @brief The first line with the name
+        const received_line* lineOf(std::string_view name) const
+        {
+            if (auto h = to_known_header(name); h != known_header::Other) return lineOf(h);
+            for (auto& l : lines) {
+                if (!l.repeat && header_name_equals(nameOf(l), name)) return &l;
+            }
+            return nullptr;
+        }
+
+        /// @brief Index the line of the block starting at the offset. A repeated header is chained to its first line whose
+        /// folded value is extended in place if it is the last one folded and copied to the end of the folds otherwise.
+        void indexLine(size_t offset)
+        {
+            auto l     = lineAt(block, offset);
+            auto index = static_cast<uint32_t>(lines.size());
+            auto found = lineOf(nameOf(l));
+            if (found == nullptr) {
+                if (auto h = to_known_header(nameOf(l)); h != known_header::Other) known[static_cast<size_t>(h)] = index;
+                distinctCount++;
+                lines.push_back(l);
+                return;
+            }
+
+            // The values of a repeated header are folded into a comma separated list (RFC 7230 section 3.2.2)
+            auto& first = lines[static_cast<size_t>(found - lines.data())];
+            auto* last  = &first;
+            while (last->next != NO_LINE) last = &lines[last->next];
+            if (first.foldOffset == NO_LINE || size_t {first.foldOffset} + first.foldLength != folds.length()) {
+                first.foldOffset = static_cast<uint32_t>(folds.length());
+                folds.append(rawValueOf(first));
+                for (auto i = first.next; i != NO_LINE; i = lines[i].next) folds.append(", ").append(rawValueOf(lines[i]));
+            }
+            folds.append(", ").append(rawValueOf(l));
+            first.foldLength = static_cast<uint32_t>(folds.length()) - first.foldOffset;
+            last->next       = index;
+            l.repeat         = true;
+            lines.push_back(l);
+        }
+
+        /// @brief Convert the received block into entries; repeated headers are folded
+        void unblock()
+        {
+            if (block.empty()) return;
+
+            std::string raw;
+            std::swap(raw, block);
+            lines.clear();
+            for (size_t pos = 0; pos < raw.length();) {
+                auto l     = lineAt(raw, pos);
+                auto name  = std::string_view(raw).substr(l.offset, l.nameLength);
+                auto value = std::string_view(raw).substr(size_t {l.offset} + l.nameLength + 2, l.valueLength);
+                if (auto* e = findMutable(name); e != nullptr) e->value.append(", ").append(value);
+                else
+                    push(name, value, value_kind::String);
+                pos = nextLine(l);
+            }
+        }
+
+        static nlohmann::json toJson(const entry& e)
+        {
+            switch (e.kind) {
+                case value_kind::Signed: {
+                    int64_t n {0};
+                    std::from_chars(e.value.data(), e.value.data() + e.value.length(), n);
+                    return n;
+                }
+                case value_kind::Unsigned: {
+                    uint64_t n {0};
+                    std::from_chars(e.value.data(), e.value.data() + e.value.length(), n);
+                    return n;
+                }
+                case value_kind::Boolean: return e.value == "true";
+                case value_kind::Json: return nlohmann::json::parse(e.value, nullptr, false);
+                default: return e.value;
+            }
+        }
+
+    private:
+        mutable std::array<entry, INLINE_CAPACITY> fixed {};
+        mutable std::vector<entry>                 overflow {};
+        mutable size_t                             count {0};
+
+        /// @brief Shared immutable headers beneath this store and, for a shared store, its pre-encoded wire form
+        mutable std::shared_ptr<const http_headers> base {};
+        std::string                                 wire {};
+
+        /// @brief Headers as received (see receive()) and their index: offsets into the block and the line of each known header
+        mutable std::string                           block {};
+        std::vector<received_line>                    lines {};
+        std::string                                   folds {}; // the values of the repeated headers
+        size_t                                        distinctCount {0};
+        std::array<uint32_t, KnownHeaderNames.size()> known {};
+
+        /// @brief The json view; authoritative while viewLive, a current snapshot while viewFresh
+        mutable nlohmann::json view {};
+        mutable bool           viewLive {false};
+        mutable bool           viewFresh {false};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_HEADERS_HPP
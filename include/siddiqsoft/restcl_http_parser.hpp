@@ -0,0 +1,353 @@
+/*
+    restcl : Incremental HTTP/1.1 response parser
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_HTTP_PARSER_HPP
+#define RESTCL_HTTP_PARSER_HPP
+
+
+#include <string_view>
+#include <charconv>
+#include <cstdint>
+#include <cstddef>
+#include <bit>
+#include <algorithm>
+#include <system_error>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RESTCL_SCAN_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define RESTCL_SCAN_NEON 1
+#endif
+
+
+#include "restcl_headers.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Offset of the first occurrence of the byte; 16 bytes are compared at a time with SSE2 or NEON where available
+    /// @return Offset or std::string_view::npos
+    inline size_t find_byte(std::string_view s, char c) noexcept
+    {
+        auto   p = s.data();
+        auto   n = s.length();
+        size_t i = 0;
+
+#if defined(RESTCL_SCAN_SSE2)
+        const __m128i needle = _mm_set1_epi8(c);
+        for (; i + 16 <= n; i += 16) {
+            auto mask = static_cast<unsigned>(
+                    _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)), needle)));
+            if (mask != 0) return i + std::countr_zero(mask);
+        }
+#elif defined(RESTCL_SCAN_NEON)
+        const uint8x16_t needle = vdupq_n_u8(static_cast<uint8_t>(c));
+        for (; i + 16 <= n; i += 16) {
+            uint8x16_t eq = vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(p + i)), needle);
+            // Narrow each byte of the comparison to a nibble of a 64-bit mask
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+            if (mask != 0) return i + (std::countr_zero(mask) >> 2);
+        }
+#endif
+
+        for (; i < n; i++) {
+            if (p[i] == c) return i;
+        }
+        return std::string_view::npos;
+    }
+
+
+    /// @brief Incremental, zero-copy parser for a HTTP/1.1 response.
+    /// The input may arrive in pieces of any size: parse() consumes what it can and the caller presents the unconsumed
+    /// remainder again along with the next piece. The status line, headers and body are reported to the handler as views
+    /// into the input which are valid for the duration of the call; body bytes are always consumed so they need not be
+    /// buffered by the caller. Chunked transfer coding (with chunk extensions and trailers), Content-Length and responses
+    /// delimited by the close of the connection are supported; interim (1xx) responses are skipped.
+    ///
+    /// The handler provides:
+    /// @code
+    /// void on_status(std::string_view version, uint32_t status, std::string_view reason);
+    /// void on_header(std::string_view name, std::string_view value);
+    /// void on_headers_complete();
+    /// void on_body(std::string_view part);
+    /// void on_trailer(std::string_view name, std::string_view value); // optional
+    /// @endcode
+    class http_response_parser
+    {
+    public:
+        /// @brief Longest status line, header line or chunk size line accepted
+        static constexpr size_t MAX_LINE {65536};
+
+        /// @brief The response to a HEAD request has no body regardless of its headers
+        void set_head_request(bool head) { headRequest = head; }
+
+        /// @brief Parse as much of the input as possible
+        /// @param in The unconsumed remainder of the previous call followed by the newly received bytes
+        /// @param h Handler
+        /// @return Number of bytes consumed
+        template <class Handler>
+        size_t parse(std::string_view in, Handler& h)
+        {
+            size_t offset = 0;
+            while (offset < in.length() && state != phase::Complete && state != phase::Error) {
+                auto pending = in.substr(offset);
+
+                if (state == phase::Body || state == phase::ChunkData) {
+                    auto n = std::min<size_t>(remaining, pending.length());
+                    h.on_body(pending.substr(0, n));
+                    offset += n;
+                    remaining -= n;
+                    if (remaining == 0) state = state == phase::Body ? phase::Complete : phase::ChunkDataEnd;
+                }
+                else if (state == phase::UntilClose) {
+                    h.on_body(pending);
+                    offset = in.length();
+                }
+                else {
+                    auto eol = find_byte(pending, '\n');
+                    if (eol == std::string_view::npos) {
+                        if (pending.length() > MAX_LINE) state = phase::Error;
+                        break;
+                    }
+                    auto line = pending.substr(0, eol);
+                    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+                    offset += eol + 1;
+                    onLine(line, h);
+                }
+            }
+            return offset;
+        }
+
+        /// @brief The peer closed the connection; completes a response delimited by the close
+        /// @return true if the response is complete
+        bool finish()
+        {
+            if (state == phase::UntilClose) state = phase::Complete;
+            return state == phase::Complete;
+        }
+
+        bool complete() const { return state == phase::Complete; }
+        bool failed() const { return state == phase::Error; }
+
+        /// @brief True if the connection may be reused for another request once the response is complete
+        bool keep_alive() const { return keepAlive; }
+
+        /// @brief The final status code; 0 until the status line has been parsed
+        uint32_t status() const { return statusCode; }
+
+    private:
+        enum class phase
+        {
+            StatusLine,
+            Headers,
+            Body,
+            ChunkSize,
+            ChunkData,
+            ChunkDataEnd,
+            Trailers,
+            UntilClose,
+            Complete,
+            Error
+        };
+
+        static std::string_view trim(std::string_view s)
+        {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+            return s;
+        }
+
+        /// @brief True if the comma separated list contains the token (case-insensitive)
+        static bool hasToken(std::string_view list, std::string_view token)
+        {
+            while (!list.empty()) {
+                auto comma = list.find(',');
+                if (header_name_equals(trim(list.substr(0, comma)), token)) return true;
+                list.remove_prefix(comma == std::string_view::npos ? list.length() : comma + 1);
+            }
+            return false;
+        }
+
+        /// @brief Split a header line into its trimmed name and value
+        /// @return false if the line has no colon
+        static bool splitHeader(std::string_view line, std::string_view& name, std::string_view& value)
+        {
+            auto colon = find_byte(line, ':');
+            if (colon == std::string_view::npos) return false;
+            name  = trim(line.substr(0, colon));
+            value = trim(line.substr(colon + 1));
+            return true;
+        }
+
+        template <class Handler>
+        void onLine(std::string_view line, Handler& h)
+        {
+            switch (state) {
+                case phase::StatusLine: return onStatusLine(line, h);
+                case phase::Headers: return onHeaderLine(line, h);
+
+                case phase::ChunkSize: {
+                    // chunk-size [ ; chunk-ext ]
+                    size_t size {0};
+                    auto   r = std::from_chars(line.data(), line.data() + line.length(), size, 16);
+                    if (r.ec != std::errc {} || (r.ptr != line.data() + line.length() && *r.ptr != ';' && *r.ptr != ' ' && *r.ptr != '\t')) {
+                        state = phase::Error;
+                        return;
+                    }
+                    remaining = size;
+                    state     = size == 0 ? phase::Trailers : phase::ChunkData;
+                    return;
+                }
+
+                case phase::ChunkDataEnd: state = line.empty() ? phase::ChunkSize : phase::Error; return;
+
+                case phase::Trailers: {
+                    if (line.empty()) {
+                        state = phase::Complete;
+                        return;
+                    }
+                    std::string_view name, value;
+                    if constexpr (requires { h.on_trailer(name, value); }) {
+                        if (splitHeader(line, name, value)) h.on_trailer(name, value);
+                    }
+                    return;
+                }
+
+                default: return;
+            }
+        }
+
+        template <class Handler>
+        void onStatusLine(std::string_view line, Handler& h)
+        {
+            // Tolerate empty lines preceding the status line
+            if (line.empty()) return;
+
+            // HTTP-version SP status-code SP [ reason-phrase ]
+            auto sp1 = line.find(' ');
+            if (!line.starts_with("HTTP/") || sp1 == std::string_view::npos) {
+                state = phase::Error;
+                return;
+            }
+            auto     version = line.substr(0, sp1);
+            auto     rest    = line.substr(sp1 + 1);
+            auto     sp2     = rest.find(' ');
+            auto     code    = rest.substr(0, sp2);
+            uint32_t value {0};
+            if (code.length() != 3 || std::from_chars(code.data(), code.data() + 3, value).ec != std::errc {}) {
+                state = phase::Error;
+                return;
+            }
+
+            interim       = value >= 100 && value < 200;
+            state         = phase::Headers;
+            contentLength = -1;
+            chunked       = false;
+            if (interim) return;
+
+            statusCode = value;
+            keepAlive  = version != "HTTP/1.0";
+            h.on_status(version, value, sp2 == std::string_view::npos ? std::string_view {} : rest.substr(sp2 + 1));
+        }
+
+        template <class Handler>
+        void onHeaderLine(std::string_view line, Handler& h)
+        {
+            if (line.empty()) return onHeadersComplete(h);
+
+            std::string_view name, value;
+            if (!splitHeader(line, name, value) || interim) return;
+
+            if (header_name_equals(name, "Content-Length")) {
+                if (std::from_chars(value.data(), value.data() + value.length(), contentLength).ec != std::errc {} || contentLength < 0) {
+                    state = phase::Error;
+                    return;
+                }
+            }
+            else if (header_name_equals(name, "Transfer-Encoding")) {
+                chunked = hasToken(value, "chunked");
+            }
+            else if (header_name_equals(name, "Connection")) {
+                if (hasToken(value, "close")) keepAlive = false;
+                else if (hasToken(value, "keep-alive"))
+                    keepAlive = true;
+            }
+
+            h.on_header(name, value);
+        }
+
+        template <class Handler>
+        void onHeadersComplete(Handler& h)
+        {
+            if (interim) {
+                state = phase::StatusLine;
+                return;
+            }
+
+            h.on_headers_complete();
+
+            // No body for HEAD, 204 and 304
+            if (headRequest || statusCode == 204 || statusCode == 304) {
+                state = phase::Complete;
+            }
+            else if (chunked) {
+                state = phase::ChunkSize;
+            }
+            else if (contentLength >= 0) {
+                remaining = static_cast<size_t>(contentLength);
+                state     = remaining > 0 ? phase::Body : phase::Complete;
+            }
+            else {
+                // Delimited by the server closing the connection
+                keepAlive = false;
+                state     = phase::UntilClose;
+            }
+        }
+
+    private:
+        phase    state {phase::StatusLine};
+        bool     headRequest {false};
+        bool     interim {false};
+        bool     chunked {false};
+        bool     keepAlive {true};
+        int64_t  contentLength {-1};
+        size_t   remaining {0};
+        uint32_t statusCode {0};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_HTTP_PARSER_HPP
@@ -0,0 +1,173 @@
+/*
+    restcl : Move-only callable with inline storage
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_INPLACE_FUNCTION_HPP
+#define RESTCL_INPLACE_FUNCTION_HPP
+
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace siddiqsoft
+{
+    template <class Signature, size_t Capacity = 64>
+    class inplace_function;
+
+    /// @brief Move-only callable which holds the target inline when it fits in Capacity bytes (and is nothrow movable);
+    /// larger targets are held on the heap. Unlike std::function the target need not be copyable and moving the
+    /// inline target does not allocate.
+    /// @tparam R Result type
+    /// @tparam Args Argument types
+    /// @tparam Capacity Bytes of inline storage
+    template <class R, class... Args, size_t Capacity>
+    class inplace_function<R(Args...), Capacity>
+    {
+        /// @brief Operations on the target of a given type
+        struct ops_type
+        {
+            R (*invoke)(void*, Args&&...) {nullptr};
+            void (*relocate)(void* dest, void* src) noexcept {nullptr}; // move-constructs dest and destroys src
+            void (*destroy)(void*) noexcept {nullptr};
+        };
+
+        template <class F>
+        static constexpr bool fits_inline =
+                sizeof(F) <= Capacity && alignof(F) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<F>;
+
+        template <class F>
+        static constexpr ops_type make_ops()
+        {
+            if constexpr (fits_inline<F>) {
+                return {[](void* s, Args&&... args) -> R { return std::invoke(*static_cast<F*>(s), std::forward<Args>(args)...); },
+                        [](void* d, void* s) noexcept {
+                            ::new (d) F(std::move(*static_cast<F*>(s)));
+                            static_cast<F*>(s)->~F();
+                        },
+                        [](void* s) noexcept { static_cast<F*>(s)->~F(); }};
+            }
+            else {
+                // The storage holds the pointer to the target
+                return {[](void* s, Args&&... args) -> R { return std::invoke(**static_cast<F**>(s), std::forward<Args>(args)...); },
+                        [](void* d, void* s) noexcept { *static_cast<F**>(d) = *static_cast<F**>(s); },
+                        [](void* s) noexcept { delete *static_cast<F**>(s); }};
+            }
+        }
+
+        template <class F>
+        static constexpr ops_type ops_v = make_ops<F>();
+
+    public:
+        inplace_function() noexcept = default;
+        inplace_function(std::nullptr_t) noexcept { }
+
+        template <class F>
+            requires(!std::is_same_v<std::remove_cvref_t<F>, inplace_function> && std::is_invocable_r_v<R, std::decay_t<F>&, Args...>)
+        inplace_function(F&& f)
+        {
+            using T = std::decay_t<F>;
+            if constexpr (std::is_pointer_v<T> || std::is_member_pointer_v<T> ||
+                          requires { static_cast<bool>(f == nullptr); }) {
+                if (f == nullptr) return;
+            }
+            if constexpr (fits_inline<T>) ::new (static_cast<void*>(storage)) T(std::forward<F>(f));
+            else
+                *reinterpret_cast<T**>(storage) = new T(std::forward<F>(f));
+            ops = &ops_v<T>;
+        }
+
+        inplace_function(inplace_function&& src) noexcept { take(src); }
+
+        inplace_function& operator=(inplace_function&& src) noexcept
+        {
+            if (this != &src) {
+                reset();
+                take(src);
+            }
+            return *this;
+        }
+
+        inplace_function& operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        inplace_function(const inplace_function&)            = delete;
+        inplace_function& operator=(const inplace_function&) = delete;
+
+        ~inplace_function() { reset(); }
+
+
+        explicit operator bool() const noexcept { return ops != nullptr; }
+
+        /// @brief Invoke the target
+        /// @throws std::bad_function_call if empty
+        R operator()(Args... args) const
+        {
+            if (ops == nullptr) throw std::bad_function_call();
+            return ops->invoke(const_cast<std::byte*>(storage), std::forward<Args>(args)...);
+        }
+
+        /// @brief Destroy the target
+        void reset() noexcept
+        {
+            if (ops != nullptr) {
+                ops->destroy(storage);
+                ops = nullptr;
+            }
+        }
+
+    private:
+        void take(inplace_function& src) noexcept
+        {
+            if (src.ops != nullptr) {
+                src.ops->relocate(storage, src.storage);
+                ops     = src.ops;
+                src.ops = nullptr;
+            }
+        }
+
+    private:
+        alignas(std::max_align_t) std::byte storage[Capacity < sizeof(void*) ? sizeof(void*) : Capacity] {};
+        const ops_type* ops {nullptr};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_INPLACE_FUNCTION_HPP
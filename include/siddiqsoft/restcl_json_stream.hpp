@@ -0,0 +1,701 @@
+/*
+    restcl : Incremental json parser for the response content
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_JSON_STREAM_HPP
+#define RESTCL_JSON_STREAM_HPP
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <charconv>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <system_error>
+#include <utility>
+
+
+#include "nlohmann/json.hpp"
+
+
+namespace siddiqsoft
+{
+    /// @brief Push parser for json which accepts the document in arbitrary pieces (as they arrive from the network) and
+    /// reports it to a nlohmann SAX handler. Unlike nlohmann::json::sax_parse() the input does not have to be complete: the
+    /// state of a partial token is kept between calls to feed() so neither the raw document nor a DOM is materialized.
+    ///
+    /// Parsing stops when the handler returns false from any of its events or once the input is found to be invalid; the
+    /// handler's parse_error() is invoked in the latter case.
+    /// @tparam SAX A type which models the nlohmann::json_sax interface; defaults to the abstract nlohmann::json::json_sax_t
+    template <class SAX = nlohmann::json::json_sax_t>
+    class json_stream_parser
+    {
+    public:
+        /// @brief Construct the parser
+        /// @param handler The handler receives the events; it must outlive the parser
+        explicit json_stream_parser(SAX& handler)
+            : sax(&handler)
+        {
+        }
+
+        /// @brief Parse the next piece of the document
+        /// @param in The bytes following those of the previous call; need not end on a token boundary
+        /// @return false once the parse has failed or the handler has stopped it; further input is ignored
+        bool feed(std::string_view in)
+        {
+            size_t i = 0;
+            while (i < in.length() && !halted()) {
+                switch (lex) {
+                    case lexeme::String: i = scanString(in, i); break;
+                    case lexeme::Number: i = scanNumber(in, i); break;
+                    case lexeme::Literal: i = scanLiteral(in, i); break;
+                    default: i = structural(in, i); break;
+                }
+            }
+            consumed += in.length();
+            return !halted();
+        }
+
+        /// @brief Signal the end of the document; a trailing number or literal is completed and a truncated document is
+        /// reported to the handler as a parse error.
+        /// @return true if the document was valid (or the handler stopped the parse)
+        bool finish()
+        {
+            if (halted()) return !failed;
+
+            if (lex == lexeme::Number) endNumber(0);
+            else if (lex == lexeme::Literal)
+                endLiteral(0);
+            else if (lex == lexeme::String)
+                fail(0, "unterminated string");
+
+            if (!halted() && state != expect::Done) fail(0, "unexpected end of input");
+            return !failed;
+        }
+
+        /// @brief True once a complete document has been parsed
+        bool complete() const { return state == expect::Done && lex == lexeme::None && !failed; }
+
+        /// @brief True if the input is not valid json
+        bool error() const { return failed; }
+
+        /// @brief True if the handler returned false from one of the events
+        bool stopped() const { return cancelled; }
+
+        /// @brief Number of bytes fed to the parser
+        size_t position() const { return consumed; }
+
+    private:
+        enum class expect : uint8_t
+        {
+            Value,
+            ValueOrEnd, // after '['
+            Key,
+            KeyOrEnd, // after '{'
+            Colon,
+            CommaOrEnd,
+            Done
+        };
+
+        enum class lexeme : uint8_t
+        {
+            None,
+            String,
+            Number,
+            Literal
+        };
+
+        enum class escape : uint8_t
+        {
+            None,
+            Backslash,
+            Hex,
+            LowBackslash, // expecting the "\u" of the low surrogate
+            LowU
+        };
+
+        bool halted() const { return failed || cancelled; }
+
+        static bool whitespace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+        void fail(size_t at, const char* msg)
+        {
+            failed   = true;
+            auto pos = consumed + at;
+            sax->parse_error(pos, token, nlohmann::detail::parse_error::create(101, pos, msg, nullptr));
+        }
+
+        /// @brief Record the handler's verdict for an event
+        bool accept(bool ok)
+        {
+            if (!ok) cancelled = true;
+            return ok;
+        }
+
+        /// @brief A value (scalar or container) has been completed
+        void afterValue() { state = stack.empty() ? expect::Done : expect::CommaOrEnd; }
+
+        void closeContainer()
+        {
+            bool ok = stack.back() == '{' ? sax->end_object() : sax->end_array();
+            stack.pop_back();
+            if (accept(ok)) afterValue();
+        }
+
+        size_t structural(std::string_view in, size_t i)
+        {
+            auto c = in[i];
+            if (whitespace(c)) return i + 1;
+
+            switch (state) {
+                case expect::ValueOrEnd:
+                    if (c == ']') {
+                        closeContainer();
+                        return i + 1;
+                    }
+                    [[fallthrough]];
+                case expect::Value: return beginValue(in, i);
+
+                case expect::KeyOrEnd:
+                    if (c == '}') {
+                        closeContainer();
+                        return i + 1;
+                    }
+                    [[fallthrough]];
+                case expect::Key:
+                    if (c == '"') {
+                        lex   = lexeme::String;
+                        isKey = true;
+                        token.clear();
+                        return i + 1;
+                    }
+                    fail(i, "expected a string for the object key");
+                    return i;
+
+                case expect::Colon:
+                    if (c == ':') {
+                        state = expect::Value;
+                        return i + 1;
+                    }
+                    fail(i, "expected ':'");
+                    return i;
+
+                case expect::CommaOrEnd:
+                    if (c == ',') {
+                        state = stack.back() == '{' ? expect::Key : expect::Value;
+                        return i + 1;
+                    }
+                    if ((c == '}' && stack.back() == '{') || (c == ']' && stack.back() == '[')) {
+                        closeContainer();
+                        return i + 1;
+                    }
+                    fail(i, "expected ',' or the end of the container");
+                    return i;
+
+                default: fail(i, "unexpected character after the document"); return i;
+            }
+        }
+
+        size_t beginValue(std::string_view in, size_t i)
+        {
+            auto c = in[i];
+            switch (c) {
+                case '{':
+                    stack.push_back('{');
+                    state = expect::KeyOrEnd;
+                    accept(sax->start_object(static_cast<size_t>(-1)));
+                    return i + 1;
+                case '[':
+                    stack.push_back('[');
+                    state = expect::ValueOrEnd;
+                    accept(sax->start_array(static_cast<size_t>(-1)));
+                    return i + 1;
+                case '"':
+                    lex   = lexeme::String;
+                    isKey = false;
+                    token.clear();
+                    return i + 1;
+                case 't':
+                case 'f':
+                case 'n':
+                    lex = lexeme::Literal;
+                    token.clear();
+                    return i;
+                default:
+                    if (c == '-' || (c >= '0' && c <= '9')) {
+                        lex = lexeme::Number;
+                        token.clear();
+                        return i;
+                    }
+                    fail(i, "unexpected character");
+                    return i;
+            }
+        }
+
+        size_t scanString(std::string_view in, size_t i)
+        {
+            while (i < in.length() && !halted()) {
+                if (esc == escape::None) {
+                    // Copy the run of plain characters in one go
+                    auto start = i;
+                    while (i < in.length()) {
+                        auto c = static_cast<unsigned char>(in[i]);
+                        if (c == '"' || c == '\\' || c < 0x20) break;
+                        i++;
+                    }
+                    token.append(in.data() + start, i - start);
+                    if (i == in.length()) break;
+
+                    auto c = in[i++];
+                    if (c == '"') {
+                        endString();
+                        return i;
+                    }
+                    if (c == '\\') esc = escape::Backslash;
+                    else
+                        fail(i - 1, "control character in string");
+                    continue;
+                }
+
+                auto c = in[i++];
+                switch (esc) {
+                    case escape::Backslash:
+                        esc = escape::None;
+                        switch (c) {
+                            case '"': token += '"'; break;
+                            case '\\': token += '\\'; break;
+                            case '/': token += '/'; break;
+                            case 'b': token += '\b'; break;
+                            case 'f': token += '\f'; break;
+                            case 'n': token += '\n'; break;
+                            case 'r': token += '\r'; break;
+                            case 't': token += '\t'; break;
+                            case 'u':
+                                esc       = escape::Hex;
+                                hexDigits = 0;
+                                codepoint = 0;
+                                break;
+                            default: fail(i - 1, "invalid escape sequence");
+                        }
+                        break;
+
+                    case escape::Hex: {
+                        uint32_t digit = (c >= '0' && c <= '9')   ? uint32_t(c - '0')
+                                         : (c >= 'a' && c <= 'f') ? uint32_t(c - 'a' + 10)
+                                         : (c >= 'A' && c <= 'F') ? uint32_t(c - 'A' + 10)
+                                                                  : 16;
+                        if (digit == 16) {
+                            fail(i - 1, "invalid \\u escape");
+                            break;
+                        }
+                        codepoint = (codepoint << 4) | digit;
+                        if (++hexDigits == 4) endCodepoint(i);
+                        break;
+                    }
+
+                    case escape::LowBackslash:
+                        if (c == '\\') esc = escape::LowU;
+                        else
+                            fail(i - 1, "expected the low surrogate");
+                        break;
+
+                    case escape::LowU:
+                        if (c == 'u') {
+                            esc       = escape::Hex;
+                            hexDigits = 0;
+                            codepoint = 0;
+                        }
+                        else
+                            fail(i - 1, "expected the low surrogate");
+                        break;
+
+                    default: break;
+                }
+            }
+            return i;
+        }
+
+        void endCodepoint(size_t i)
+        {
+            esc = escape::None;
+            if (highSurrogate != 0) {
+                if (codepoint < 0xDC00 || codepoint > 0xDFFF) return fail(i, "invalid low surrogate");
+                codepoint     = 0x10000 + ((highSurrogate - 0xD800) << 10) + (codepoint - 0xDC00);
+                highSurrogate = 0;
+            }
+            else if (codepoint >= 0xD800 && codepoint <= 0xDBFF) {
+                highSurrogate = codepoint;
+                esc           = escape::LowBackslash;
+                return;
+            }
+            else if (codepoint >= 0xDC00 && codepoint <= 0xDFFF) {
+                return fail(i, "unpaired low surrogate");
+            }
+
+            // UTF-8 encode
+            if (codepoint < 0x80) {
+                token += static_cast<char>(codepoint);
+            }
+            else if (codepoint < 0x800) {
+                token += static_cast<char>(0xC0 | (codepoint >> 6));
+                token += static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else if (codepoint < 0x10000) {
+                token += static_cast<char>(0xE0 | (codepoint >> 12));
+                token += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                token += static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+            else {
+                token += static_cast<char>(0xF0 | (codepoint >> 18));
+                token += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+                token += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+                token += static_cast<char>(0x80 | (codepoint & 0x3F));
+            }
+        }
+
+        void endString()
+        {
+            lex = lexeme::None;
+            if (isKey) {
+                if (accept(sax->key(token))) state = expect::Colon;
+            }
+            else if (accept(sax->string(token))) {
+                afterValue();
+            }
+        }
+
+        size_t scanNumber(std::string_view in, size_t i)
+        {
+            auto start = i;
+            while (i < in.length()) {
+                auto c = in[i];
+                if (!((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E')) break;
+                i++;
+            }
+            token.append(in.data() + start, i - start);
+            // The number continues in the next piece unless we found its end
+            if (i < in.length()) endNumber(i);
+            return i;
+        }
+
+        /// @brief Validates against the json grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+        static bool validNumber(std::string_view s, bool& integral)
+        {
+            size_t i      = 0;
+            auto   digits = [&]() {
+                auto start = i;
+                while (i < s.length() && s[i] >= '0' && s[i] <= '9') i++;
+                return i > start;
+            };
+
+            integral = true;
+            if (i < s.length() && s[i] == '-') i++;
+            if (i < s.length() && s[i] == '0') i++;
+            else if (!digits())
+                return false;
+            if (i < s.length() && s[i] == '.') {
+                i++;
+                integral = false;
+                if (!digits()) return false;
+            }
+            if (i < s.length() && (s[i] == 'e' || s[i] == 'E')) {
+                i++;
+                integral = false;
+                if (i < s.length() && (s[i] == '+' || s[i] == '-')) i++;
+                if (!digits()) return false;
+            }
+            return i == s.length();
+        }
+
+        void endNumber(size_t i)
+        {
+            lex = lexeme::None;
+
+            bool integral {true};
+            if (!validNumber(token, integral)) return fail(i, "invalid number");
+
+            auto first = token.data();
+            auto last  = token.data() + token.length();
+            bool ok {false};
+
+            if (integral && token.front() == '-') {
+                int64_t v {0};
+                if (std::from_chars(first, last, v).ec == std::errc {}) ok = accept(sax->number_integer(v));
+                else
+                    integral = false; // out of range; fall back to double as nlohmann does
+            }
+            else if (integral) {
+                uint64_t v {0};
+                if (std::from_chars(first, last, v).ec == std::errc {}) ok = accept(sax->number_unsigned(v));
+                else
+                    integral = false;
+            }
+
+            if (!integral) {
+                double v {0};
+                if (std::from_chars(first, last, v).ec != std::errc {}) return fail(i, "number overflow");
+                ok = accept(sax->number_float(v, token));
+            }
+
+            if (ok) afterValue();
+        }
+
+        size_t scanLiteral(std::string_view in, size_t i)
+        {
+            while (i < in.length() && in[i] >= 'a' && in[i] <= 'z') {
+                if (token.length() == 5) {
+                    fail(i, "invalid literal");
+                    return i;
+                }
+                token += in[i++];
+            }
+            if (i < in.length()) endLiteral(i);
+            return i;
+        }
+
+        void endLiteral(size_t i)
+        {
+            lex = lexeme::None;
+
+            bool ok {false};
+            if (token == "true") ok = accept(sax->boolean(true));
+            else if (token == "false")
+                ok = accept(sax->boolean(false));
+            else if (token == "null")
+                ok = accept(sax->null());
+            else
+                return fail(i, "invalid literal");
+
+            if (ok) afterValue();
+        }
+
+    private:
+        SAX*              sax {nullptr};
+        std::vector<char> stack {}; // '{' or '[' for each open container
+        std::string       token {}; // the partial string, number or literal
+        expect            state {expect::Value};
+        lexeme            lex {lexeme::None};
+        escape            esc {escape::None};
+        bool              isKey {false};
+        bool              failed {false};
+        bool              cancelled {false};
+        uint8_t           hexDigits {0};
+        uint32_t          codepoint {0};
+        uint32_t          highSurrogate {0};
+        size_t            consumed {0};
+    };
+
+
+    /// @brief SAX handler which keeps only the values at the given json pointers and discards everything else without
+    /// building it. The values are placed at their pointer in result() so the result has the shape of the document
+    /// restricted to the selected values; array elements preceding a selected element are null.
+    ///
+    /// The handler stops the parse (returns false) as soon as every pointer has been found.
+    class json_pointer_collector : public nlohmann::json::json_sax_t
+    {
+    public:
+        using json = nlohmann::json;
+
+        /// @brief Construct the collector
+        /// @param pointers The values to keep; a pointer within another selected pointer is redundant and ignored
+        explicit json_pointer_collector(const std::vector<json::json_pointer>& pointers)
+        {
+            std::vector<std::string> sorted {};
+            for (auto& p : pointers) sorted.push_back(p.to_string());
+            std::sort(sorted.begin(), sorted.end());
+            // Sorted, a pointer follows its ancestors so comparing with the last one kept drops duplicates and nested
+            // pointers alike.
+            for (auto& p : sorted) {
+                if (!wanted.empty()) {
+                    const auto& q = wanted.back();
+                    if (p == q || (q.length() < p.length() && p.starts_with(q) && p[q.length()] == '/')) continue;
+                }
+                wanted.push_back(std::move(p));
+            }
+        }
+
+        /// @brief The selected values
+        const json& result() const { return doc; }
+        json&       result() { return doc; }
+
+        /// @brief True once every pointer has been found
+        bool complete() const { return found == wanted.size(); }
+
+        /// @brief The parse error reported by the parser, if any
+        const std::string& error() const { return lastError; }
+
+    public:
+        bool null() override { return scalar(json(nullptr)); }
+        bool boolean(bool v) override { return scalar(json(v)); }
+        bool number_integer(number_integer_t v) override { return scalar(json(v)); }
+        bool number_unsigned(number_unsigned_t v) override { return scalar(json(v)); }
+        bool number_float(number_float_t v, const string_t&) override { return scalar(json(v)); }
+        bool string(string_t& v) override { return scalar(json(std::move(v))); }
+        bool binary(binary_t& v) override { return scalar(json::binary(std::move(v))); }
+
+        bool start_object(std::size_t) override { return open(json::value_t::object); }
+        bool start_array(std::size_t) override { return open(json::value_t::array); }
+        bool end_object() override { return close(); }
+        bool end_array() override { return close(); }
+
+        bool key(string_t& k) override
+        {
+            if (!building.empty()) {
+                pendingKey = k;
+                return true;
+            }
+
+            frames.back().key = k;
+            path.resize(frames.back().length);
+            path += '/';
+            for (auto c : k) {
+                if (c == '~') path += "~0";
+                else if (c == '/')
+                    path += "~1";
+                else
+                    path += c;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override
+        {
+            lastError = e.what();
+            return false;
+        }
+
+    private:
+        struct frame
+        {
+            bool        array {false};
+            size_t      index {0};
+            size_t      length {0}; // length of the path of the container
+            std::string key {};    // current member of an object
+        };
+
+        /// @brief Update the path for the value which begins; object members were located by key()
+        void locate()
+        {
+            if (frames.empty() || !frames.back().array) return;
+            auto& f = frames.back();
+            path.resize(f.length);
+            path += '/';
+            path += std::to_string(f.index++);
+        }
+
+        bool selected() const { return std::binary_search(wanted.begin(), wanted.end(), path); }
+
+        /// @brief The location of the selected value in the result; the containers leading to it are created as needed
+        json& slot()
+        {
+            json* node = &doc;
+            for (auto& f : frames) {
+                if (f.array) {
+                    if (!node->is_array()) *node = json::array();
+                    while (node->size() < f.index) node->push_back(nullptr);
+                    node = &(*node)[f.index - 1];
+                }
+                else {
+                    if (!node->is_object()) *node = json::object();
+                    node = &(*node)[f.key];
+                }
+            }
+            return *node;
+        }
+
+        /// @brief Add the value to the container being built
+        json& insert(json&& v)
+        {
+            auto& parent = *building.back();
+            if (parent.is_array()) {
+                parent.push_back(std::move(v));
+                return parent.back();
+            }
+            return parent[pendingKey] = std::move(v);
+        }
+
+        bool scalar(json&& v)
+        {
+            if (!building.empty()) {
+                insert(std::move(v));
+                return true;
+            }
+
+            locate();
+            if (!selected()) return true;
+            slot() = std::move(v);
+            return ++found < wanted.size();
+        }
+
+        bool open(json::value_t t)
+        {
+            if (!building.empty()) {
+                building.push_back(&insert(json(t)));
+            }
+            else {
+                locate();
+                if (selected()) {
+                    auto& s = slot();
+                    s       = json(t);
+                    building.push_back(&s);
+                }
+            }
+            frames.push_back({t == json::value_t::array, 0, path.length()});
+            return true;
+        }
+
+        bool close()
+        {
+            frames.pop_back();
+            if (building.empty()) return true;
+            building.pop_back();
+            // The selected container is complete
+            return !building.empty() || ++found < wanted.size();
+        }
+
+    private:
+        std::vector<std::string> wanted {};
+        size_t                   found {0};
+        json                     doc {};
+        std::string              path {};
+        std::vector<frame>       frames {};
+        std::vector<json*>       building {};
+        std::string              pendingKey {};
+        std::string              lastError {};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_JSON_STREAM_HPP
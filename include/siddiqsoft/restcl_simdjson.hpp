@@ -0,0 +1,95 @@
+/*
+    restcl : simdjson backend for the response content
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_SIMDJSON_HPP
+#define RESTCL_SIMDJSON_HPP
+
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+
+#include "nlohmann/json.hpp"
+#include "simdjson.h"
+
+
+namespace siddiqsoft
+{
+    /// @brief Convert the simdjson element into a nlohmann::json with the same number types nlohmann::json::parse() yields
+    /// (non-negative integers are unsigned) and, as with parse(), the last of duplicate keys wins.
+    inline nlohmann::json to_nlohmann_json(simdjson::dom::element e)
+    {
+        switch (e.type()) {
+            case simdjson::dom::element_type::ARRAY: {
+                auto                 j   = nlohmann::json::array();
+                simdjson::dom::array arr = e.get_array().value_unsafe();
+                for (auto v : arr) j.push_back(to_nlohmann_json(v));
+                return j;
+            }
+            case simdjson::dom::element_type::OBJECT: {
+                auto                  j   = nlohmann::json::object();
+                simdjson::dom::object obj = e.get_object().value_unsafe();
+                for (auto field : obj) j[std::string(field.key)] = to_nlohmann_json(field.value);
+                return j;
+            }
+            case simdjson::dom::element_type::INT64: {
+                auto v = e.get_int64().value_unsafe();
+                if (v >= 0) return static_cast<uint64_t>(v);
+                return v;
+            }
+            case simdjson::dom::element_type::UINT64: return e.get_uint64().value_unsafe();
+            case simdjson::dom::element_type::DOUBLE: return e.get_double().value_unsafe();
+            case simdjson::dom::element_type::STRING: return std::string(e.get_string().value_unsafe());
+            case simdjson::dom::element_type::BOOL: return e.get_bool().value_unsafe();
+            default: return nullptr;
+        }
+    }
+
+    /// @brief Parse the json with simdjson and convert it into a nlohmann::json.
+    /// Documents simdjson rejects but nlohmann accepts (e.g. integers beyond 64 bits) are parsed by nlohmann.
+    /// @return The json or a discarded value if the document is not valid json
+    inline nlohmann::json simdjson_parse(std::string_view s)
+    {
+        // The parser keeps its buffers for the next document on the same thread
+        thread_local simdjson::dom::parser parser {};
+
+        simdjson::dom::element root;
+        if (parser.parse(s.data(), s.length()).get(root) == simdjson::SUCCESS) return to_nlohmann_json(root);
+        return nlohmann::json::parse(s, nullptr, false);
+    }
+} // namespace siddiqsoft
+
+#endif // !RESTCL_SIMDJSON_HPP
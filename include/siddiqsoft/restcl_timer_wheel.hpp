@@ -0,0 +1,276 @@
+/*
+    restcl : Hierarchical timer wheel
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_TIMER_WHEEL_HPP
+#define RESTCL_TIMER_WHEEL_HPP
+
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+
+namespace siddiqsoft
+{
+    /// @brief Hierarchical timer wheel (Varghese & Lauck) with a resolution of one millisecond.
+    /// Four levels of 64 slots cover about 4.6 hours; later timers wait in the last level and move down as time passes.
+    /// Scheduling and cancelling are O(1). The timers are intrusive (the owner derives from timer_wheel::timer) so that
+    /// the wheel never allocates; an occupancy mask per level finds the next due slot without scanning.
+    /// Not thread-safe; intended for the thread of an event loop.
+    class timer_wheel
+    {
+    public:
+        using clock_type = std::chrono::steady_clock;
+
+        /// @brief Base of the objects which are scheduled on the wheel
+        class timer
+        {
+            friend class timer_wheel;
+
+            timer*   prev {nullptr};
+            timer*   next {nullptr};
+            uint64_t expiry {0}; // in ticks since the start of the wheel
+            uint8_t  level {0};
+            uint8_t  slot {0};
+
+        public:
+            timer()                        = default;
+            timer(const timer&)            = delete;
+            timer& operator=(const timer&) = delete;
+
+            bool armed() const { return next != nullptr; }
+        };
+
+    private:
+        static constexpr unsigned SLOT_BITS {6};
+        static constexpr unsigned SLOTS {1u << SLOT_BITS};
+        static constexpr unsigned LEVELS {4};
+
+        /// @brief Circular list with a sentinel
+        struct slot_list
+        {
+            timer head {};
+
+            slot_list() { head.prev = head.next = &head; }
+            slot_list(const slot_list&)            = delete;
+            slot_list& operator=(const slot_list&) = delete;
+
+            bool empty() const { return head.next == &head; }
+
+            void push(timer& t)
+            {
+                t.prev          = head.prev;
+                t.next          = &head;
+                head.prev->next = &t;
+                head.prev       = &t;
+            }
+
+            /// @brief Move every timer into the (empty) list dest
+            void splice(slot_list& dest)
+            {
+                if (empty()) return;
+                dest.head.next  = head.next;
+                dest.head.prev  = head.prev;
+                head.next->prev = &dest.head;
+                head.prev->next = &dest.head;
+                head.prev = head.next = &head;
+            }
+        };
+
+    public:
+        explicit timer_wheel(clock_type::time_point start = clock_type::now())
+            : origin(start)
+        {
+        }
+
+        timer_wheel(const timer_wheel&)            = delete;
+        timer_wheel& operator=(const timer_wheel&) = delete;
+
+        ~timer_wheel()
+        {
+            // Leave the timers which are still armed in a consistent (disarmed) state
+            for (auto& level : wheel) {
+                for (auto& s : level) {
+                    while (!s.empty()) unlink(*s.head.next);
+                }
+            }
+        }
+
+
+        /// @brief Arm (or re-arm) the timer. The expiry is rounded up to the next tick so the timer never fires early; a time
+        /// in the past fires on the next advance().
+        void schedule(timer& t, clock_type::time_point when)
+        {
+            if (t.armed()) cancel(t);
+            auto ticks = when <= origin ? 0 : std::chrono::ceil<std::chrono::milliseconds>(when - origin).count();
+            t.expiry   = std::max<uint64_t>(static_cast<uint64_t>(ticks), current + 1);
+            insert(t);
+            count++;
+        }
+
+        /// @brief Disarm the timer; no effect if it is not armed
+        void cancel(timer& t)
+        {
+            if (!t.armed()) return;
+            unlink(t);
+            if (wheel[t.level][t.slot].empty()) occupied[t.level] &= ~(uint64_t {1} << t.slot);
+            count--;
+        }
+
+        /// @brief Fire the timers which are due by now. The timer is disarmed before onExpired(timer&) is invoked, which
+        /// may schedule or cancel any timer.
+        template <class F>
+        void advance(clock_type::time_point now, F&& onExpired)
+        {
+            auto target = static_cast<uint64_t>(std::max<int64_t>(
+                    0, std::chrono::duration_cast<std::chrono::milliseconds>(now - origin).count()));
+
+            while (current < target) {
+                if (count == 0) {
+                    current = target;
+                    break;
+                }
+
+                // Jump to the next occupied slot of the lowest level or to its end where the upper levels move down
+                current = std::min(nextTick(), target);
+                if ((current & (SLOTS - 1)) == 0) cascade();
+
+                auto  index = static_cast<uint8_t>(current & (SLOTS - 1));
+                auto& s     = wheel[0][index];
+                if (s.empty()) continue;
+
+                slot_list due {};
+                s.splice(due);
+                occupied[0] &= ~(uint64_t {1} << index);
+                while (!due.empty()) {
+                    auto& t = *due.head.next;
+                    unlink(t);
+                    count--;
+                    onExpired(t);
+                }
+            }
+        }
+
+        /// @brief Time until advance() has work to do (a timer is due or the timers of an upper level move down);
+        /// empty if no timer is armed
+        std::optional<std::chrono::milliseconds> next_timeout(clock_type::time_point now) const
+        {
+            if (count == 0) return std::nullopt;
+            auto ticks = std::chrono::duration_cast<std::chrono::milliseconds>(now - origin).count();
+            auto next  = static_cast<int64_t>(nextTick());
+            return std::chrono::milliseconds(std::max<int64_t>(0, next - ticks));
+        }
+
+        /// @brief Number of armed timers
+        size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+    private:
+        /// @brief The level is given by the highest 6-bit group in which the expiry differs from the current tick; the
+        /// timer moves down a level each time the current tick reaches that group.
+        void insert(timer& t)
+        {
+            // A timer which is due as it moves down lands in the current slot of the lowest level, which fires next
+            auto     expiry = std::max(t.expiry, current);
+            auto     diff   = expiry ^ current;
+            unsigned level  = diff < SLOTS ? 0 : (std::bit_width(diff) - 1) / SLOT_BITS;
+            unsigned slot   = 0;
+            if (level < LEVELS) {
+                slot = static_cast<unsigned>(expiry >> (level * SLOT_BITS)) & (SLOTS - 1);
+            }
+            else {
+                // Beyond the current turn of the last level; wait in its first slot, which moves down as the turn ends
+                level = LEVELS - 1;
+            }
+
+            t.level = static_cast<uint8_t>(level);
+            t.slot  = static_cast<uint8_t>(slot);
+            wheel[level][slot].push(t);
+            occupied[level] |= uint64_t {1} << slot;
+        }
+
+        static void unlink(timer& t)
+        {
+            t.prev->next = t.next;
+            t.next->prev = t.prev;
+            t.prev = t.next = nullptr;
+        }
+
+        /// @brief At the end of a turn of a level, move the timers of the slot now current in the levels above into the
+        /// levels below; the highest first as its timers may land in a slot of the next level which is also due
+        void cascade()
+        {
+            unsigned top = 1;
+            while (top + 1 < LEVELS && (current & ((uint64_t {1} << ((top + 1) * SLOT_BITS)) - 1)) == 0) top++;
+
+            for (unsigned level = top; level >= 1; level--) {
+                auto  index = static_cast<uint8_t>((current >> (level * SLOT_BITS)) & (SLOTS - 1));
+                auto& s     = wheel[level][index];
+                if (s.empty()) continue;
+
+                slot_list moving {};
+                s.splice(moving);
+                occupied[level] &= ~(uint64_t {1} << index);
+                while (!moving.empty()) {
+                    auto& t = *moving.head.next;
+                    unlink(t);
+                    insert(t);
+                }
+            }
+        }
+
+        /// @brief The next occupied slot of the lowest level in the current turn, or else the end of the turn
+        uint64_t nextTick() const
+        {
+            auto index = current & (SLOTS - 1);
+            auto later = index == SLOTS - 1 ? 0 : occupied[0] & (~uint64_t {0} << (index + 1));
+            if (later != 0) return (current & ~uint64_t {SLOTS - 1}) + static_cast<uint64_t>(std::countr_zero(later));
+            return (current | (SLOTS - 1)) + 1;
+        }
+
+    private:
+        clock_type::time_point                           origin;
+        uint64_t                                         current {0}; // the last tick processed
+        size_t                                           count {0};
+        std::array<uint64_t, LEVELS>                     occupied {}; // bit per slot which holds a timer
+        std::array<std::array<slot_list, SLOTS>, LEVELS> wheel {};
+    };
+} // namespace siddiqsoft
+
+#endif // !RESTCL_TIMER_WHEEL_HPP
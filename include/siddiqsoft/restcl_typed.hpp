@@ -0,0 +1,531 @@
+/*
+    restcl : Json content decoded into and encoded from structs without a DOM
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+       list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+       this list of conditions and the following disclaimer in the documentation
+       and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+       contributors may be used to endorse or promote products derived from
+       this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#pragma once
+#ifndef RESTCL_TYPED_HPP
+#define RESTCL_TYPED_HPP
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <tuple>
+#include <charconv>
+#include <concepts>
+#include <type_traits>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <format>
+
+
+#include "nlohmann/json.hpp"
+
+
+/// @brief Describe the members of a struct for the typed send (see basic_restclient::send<T>) and for
+/// basic_request::setContent(const T&). Use in place of NLOHMANN_DEFINE_TYPE_INTRUSIVE which is also provided.
+/// Members absent from the decoded json keep their default value and members not described are skipped.
+#define RESTCL_JSON_FIELD(m) , std::make_tuple(siddiqsoft::json_field {#m, &restcl_type::m})
+#define RESTCL_DEFINE_TYPE_INTRUSIVE(Type, ...)                                                                                      \
+    NLOHMANN_DEFINE_TYPE_INTRUSIVE(Type, __VA_ARGS__)                                                                                \
+    static constexpr auto restcl_fields()                                                                                            \
+    {                                                                                                                                \
+        using restcl_type = Type;                                                                                                    \
+        return std::tuple_cat(std::tuple<>() NLOHMANN_JSON_EXPAND(NLOHMANN_JSON_PASTE(RESTCL_JSON_FIELD, __VA_ARGS__)));            \
+    }
+
+
+namespace siddiqsoft
+{
+    /// @brief Name and member pointer of a described member
+    template <class C, class M>
+    struct json_field
+    {
+        std::string_view name;
+        M C::*member;
+    };
+
+    /// @brief Types described via RESTCL_DEFINE_TYPE_INTRUSIVE
+    template <class T>
+    concept json_described = requires { T::restcl_fields(); };
+
+
+    /// @brief A json scalar as reported by the parser
+    struct json_scalar
+    {
+        nlohmann::json::value_t type {nlohmann::json::value_t::null};
+        bool                    boolean {false};
+        int64_t                 integer {0};
+        uint64_t                unsigned_integer {0};
+        double                  number {0};
+        std::string*            string {nullptr};
+
+        template <class N>
+        N as() const
+        {
+            switch (type) {
+                case nlohmann::json::value_t::boolean: return static_cast<N>(boolean);
+                case nlohmann::json::value_t::number_integer: return static_cast<N>(integer);
+                case nlohmann::json::value_t::number_unsigned: return static_cast<N>(unsigned_integer);
+                default: return static_cast<N>(number);
+            }
+        }
+
+        bool arithmetic() const { return type != nlohmann::json::value_t::null && type != nlohmann::json::value_t::string; }
+    };
+
+
+    struct json_decode_ops;
+
+    /// @brief The object which receives a json value along with the operations for its type
+    struct json_decode_target
+    {
+        void*                  object {nullptr};
+        const json_decode_ops* ops {nullptr};
+    };
+
+    /// @brief Operations by which the decoder fills an object of a given type; null if the type does not support them.
+    /// Types without a direct decoding are built as a json and converted via their from_json (assign).
+    struct json_decode_ops
+    {
+        bool (*scalar)(void*, json_scalar&) {nullptr};
+        bool (*open)(void*, bool array) {nullptr};
+        json_decode_target (*member)(void*, std::string_view) {nullptr};
+        json_decode_target (*element)(void*) {nullptr};
+        json_decode_target (*engage)(void*) {nullptr}; // optional: the contained value
+        void (*assign)(void*, nlohmann::json&&) {nullptr};
+    };
+
+
+    template <class T>
+    struct is_std_optional : std::false_type
+    { };
+    template <class U>
+    struct is_std_optional<std::optional<U>> : std::true_type
+    { };
+
+    template <class T>
+    struct is_std_vector : std::false_type
+    { };
+    template <class U, class A>
+    struct is_std_vector<std::vector<U, A>> : std::true_type
+    { };
+
+
+    template <class T>
+    constexpr json_decode_ops make_json_decode_ops();
+
+    template <class T>
+    inline constexpr json_decode_ops json_decode_ops_v = make_json_decode_ops<T>();
+
+    template <class M>
+    json_decode_target json_target_of(M& m)
+    {
+        return {&m, &json_decode_ops_v<M>};
+    }
+
+
+    template <class T>
+    constexpr json_decode_ops make_json_decode_ops()
+    {
+        json_decode_ops ops {};
+
+        if constexpr (std::is_same_v<T, bool>) {
+            ops.scalar = [](void* o, json_scalar& s) {
+                if (s.type != nlohmann::json::value_t::boolean) return false;
+                *static_cast<T*>(o) = s.boolean;
+                return true;
+            };
+        }
+        else if constexpr (std::is_arithmetic_v<T>) {
+            ops.scalar = [](void* o, json_scalar& s) {
+                if (!s.arithmetic()) return false;
+                *static_cast<T*>(o) = s.as<T>();
+                return true;
+            };
+        }
+        else if constexpr (std::is_same_v<T, std::string>) {
+            ops.scalar = [](void* o, json_scalar& s) {
+                if (s.type != nlohmann::json::value_t::string) return false;
+                *static_cast<T*>(o) = std::move(*s.string);
+                return true;
+            };
+        }
+        else if constexpr (is_std_optional<T>::value) {
+            // Only a null reaches the optional; other values are decoded into the engaged value
+            ops.scalar = [](void* o, json_scalar&) {
+                static_cast<T*>(o)->reset();
+                return true;
+            };
+            ops.engage = [](void* o) { return json_target_of(static_cast<T*>(o)->emplace()); };
+        }
+        else if constexpr (is_std_vector<T>::value && !std::is_same_v<T, std::vector<bool>>) {
+            ops.open = [](void* o, bool array) {
+                if (array) static_cast<T*>(o)->clear();
+                return array;
+            };
+            ops.element = [](void* o) { return json_target_of(static_cast<T*>(o)->emplace_back()); };
+        }
+        else if constexpr (json_described<T>) {
+            ops.open   = [](void*, bool array) { return !array; };
+            ops.member = [](void* o, std::string_view name) {
+                json_decode_target t {};
+                std::apply([&](const auto&... f) { ((f.name == name ? (t = json_target_of(static_cast<T*>(o)->*f.member), true) : false) || ...); },
+                           T::restcl_fields());
+                return t;
+            };
+        }
+        else {
+            ops.assign = [](void* o, nlohmann::json&& j) {
+                if constexpr (std::is_same_v<T, nlohmann::json>) *static_cast<T*>(o) = std::move(j);
+                else
+                    j.get_to(*static_cast<T*>(o));
+            };
+        }
+
+        return ops;
+    }
+
+
+    /// @brief SAX handler which decodes the json content directly into a T guided by its type: described structs,
+    /// std::vector, std::optional, std::string, bool and arithmetic members are filled as the values are parsed, members
+    /// which are not described are skipped and any other type is built as a json and converted via its from_json.
+    /// @tparam T Default constructible
+    template <class T>
+    class struct_decoder : public nlohmann::json::json_sax_t
+    {
+    public:
+        using json = nlohmann::json;
+
+        /// @brief The decoded value
+        T&       result() { return value; }
+        const T& result() const { return value; }
+
+        /// @brief True once a complete document has been decoded into the value
+        bool valid() const { return done && lastError.empty(); }
+
+        /// @brief Reason the decoding failed
+        const std::string& error() const { return lastError; }
+
+    public:
+        bool null() override
+        {
+            return leaf({}, [] { return json(nullptr); });
+        }
+        bool boolean(bool v) override
+        {
+            return leaf({json::value_t::boolean, v}, [&] { return json(v); });
+        }
+        bool number_integer(number_integer_t v) override
+        {
+            return leaf({json::value_t::number_integer, false, v}, [&] { return json(v); });
+        }
+        bool number_unsigned(number_unsigned_t v) override
+        {
+            return leaf({json::value_t::number_unsigned, false, 0, v}, [&] { return json(v); });
+        }
+        bool number_float(number_float_t v, const string_t&) override
+        {
+            return leaf({json::value_t::number_float, false, 0, 0, v}, [&] { return json(v); });
+        }
+        bool string(string_t& v) override
+        {
+            return leaf({json::value_t::string, false, 0, 0, 0, &v}, [&] { return json(std::move(v)); });
+        }
+        bool binary(binary_t&) override { return fail("binary values are not supported"); }
+
+        bool start_object(std::size_t) override { return open(false); }
+        bool start_array(std::size_t) override { return open(true); }
+        bool end_object() override { return close(); }
+        bool end_array() override { return close(); }
+
+        bool key(string_t& k) override
+        {
+            if (!building.empty()) {
+                pendingKey = k;
+            }
+            else if (skipping == 0) {
+                auto& f    = frames.back().target;
+                pending    = f.ops->member(f.object, k);
+                currentKey = k;
+            }
+            return true;
+        }
+
+        bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& e) override { return fail(e.what()); }
+
+    private:
+        struct frame
+        {
+            json_decode_target target {};
+            bool               array {false};
+        };
+
+        bool fail(std::string msg)
+        {
+            if (lastError.empty()) lastError = std::move(msg);
+            return false;
+        }
+
+        /// @brief The target of the value which begins; null if it is to be skipped
+        json_decode_target next()
+        {
+            if (frames.empty()) {
+                if (std::exchange(started, true)) return {};
+                return json_target_of(value);
+            }
+            auto& f = frames.back();
+            if (f.array) return f.target.ops->element(f.target.object);
+            return std::exchange(pending, {});
+        }
+
+        json& insert(json&& v)
+        {
+            auto& parent = *building.back();
+            if (parent.is_array()) {
+                parent.push_back(std::move(v));
+                return parent.back();
+            }
+            return parent[pendingKey] = std::move(v);
+        }
+
+        bool assign(json_decode_target t, json&& j)
+        {
+            try {
+                t.ops->assign(t.object, std::move(j));
+                return true;
+            }
+            catch (const std::exception& e) {
+                return fail(e.what());
+            }
+        }
+
+        /// @brief A value has been completed; the document is done once the root is
+        void completed()
+        {
+            if (frames.empty() && building.empty() && skipping == 0) done = true;
+        }
+
+        bool mismatch(std::string_view what)
+        {
+            if (!frames.empty() && frames.back().array) return fail(std::format("unexpected {} for an element of \"{}\"", what, currentKey));
+            return fail(std::format("unexpected {} for \"{}\"", what, currentKey));
+        }
+
+        /// @brief A scalar value; toJson builds the value for the types decoded via json
+        template <class F>
+        bool leaf(json_scalar s, F&& toJson)
+        {
+            if (!building.empty()) {
+                insert(toJson());
+                return true;
+            }
+            if (skipping > 0) return true;
+
+            auto t = next();
+            if (t.object == nullptr) return true;
+            if (s.type != json::value_t::null) {
+                while (t.ops->engage) t = t.ops->engage(t.object);
+            }
+
+            bool ok {true};
+            if (t.ops->assign) ok = assign(t, toJson());
+            else if (t.ops->scalar == nullptr || !t.ops->scalar(t.object, s))
+                ok = mismatch(json(s.type).type_name());
+            completed();
+            return ok;
+        }
+
+        bool open(bool array)
+        {
+            auto type = array ? json::value_t::array : json::value_t::object;
+
+            if (!building.empty()) {
+                building.push_back(&insert(json(type)));
+                return true;
+            }
+            if (skipping > 0) {
+                skipping++;
+                return true;
+            }
+
+            auto t = next();
+            if (t.object == nullptr) {
+                skipping = 1;
+                return true;
+            }
+            while (t.ops->engage) t = t.ops->engage(t.object);
+
+            if (t.ops->assign) {
+                fallback    = t;
+                fallbackDoc = json(type);
+                building.push_back(&fallbackDoc);
+                return true;
+            }
+            if (t.ops->open == nullptr || !t.ops->open(t.object, array)) return mismatch(array ? "array" : "object");
+
+            frames.push_back({t, array});
+            return true;
+        }
+
+        bool close()
+        {
+            bool ok {true};
+            if (!building.empty()) {
+                building.pop_back();
+                if (building.empty()) ok = assign(fallback, std::move(fallbackDoc));
+            }
+            else if (skipping > 0) {
+                skipping--;
+            }
+            else {
+                frames.pop_back();
+            }
+            completed();
+            return ok;
+        }
+
+    private:
+        T                  value {};
+        std::vector<frame> frames {};
+        json_decode_target pending {};
+        size_t             skipping {0};
+        bool               started {false};
+        bool               done {false};
+        std::vector<json*> building {};
+        json               fallbackDoc {};
+        json_decode_target fallback {};
+        std::string        pendingKey {};
+        std::string        currentKey {};
+        std::string        lastError {};
+    };
+
+
+    /// @brief Append the json text of the value without building a json: described structs, containers, optionals,
+    /// strings, bool and arithmetic types are written directly; any other type via its to_json.
+    template <class T>
+    void append_json(std::string& out, const T& v);
+
+    /// @brief Append the string as a json string with the required escapes
+    inline void append_json_string(std::string& out, std::string_view s)
+    {
+        static constexpr char hex[] = "0123456789abcdef";
+
+        out += '"';
+        size_t run = 0;
+        for (size_t i = 0; i < s.length(); i++) {
+            auto c = static_cast<unsigned char>(s[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+            out.append(s.data() + run, i - run);
+            run = i + 1;
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    out += "\\u00";
+                    out += hex[c >> 4];
+                    out += hex[c & 0xF];
+            }
+        }
+        out.append(s.data() + run, s.length() - run);
+        out += '"';
+    }
+
+    template <class T>
+    void append_json(std::string& out, const T& v)
+    {
+        if constexpr (std::is_same_v<T, bool>) {
+            out += v ? "true" : "false";
+        }
+        else if constexpr (std::is_integral_v<T>) {
+            char buf[24];
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr);
+        }
+        else if constexpr (std::is_floating_point_v<T>) {
+            // As nlohmann::json: non-finite values are null and integral values keep a fraction
+            if (!std::isfinite(v)) {
+                out += "null";
+                return;
+            }
+            char buf[32];
+            auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr);
+            if (std::string_view(buf, r.ptr).find_first_of(".e") == std::string_view::npos) out += ".0";
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            append_json_string(out, v);
+        }
+        else if constexpr (is_std_optional<T>::value) {
+            if (v) append_json(out, *v);
+            else
+                out += "null";
+        }
+        else if constexpr (is_std_vector<T>::value) {
+            out += '[';
+            bool first {true};
+            for (const auto& e : v) {
+                if (!std::exchange(first, false)) out += ',';
+                append_json(out, static_cast<const typename T::value_type&>(e));
+            }
+            out += ']';
+        }
+        else if constexpr (json_described<T>) {
+            out += '{';
+            bool first {true};
+            std::apply(
+                    [&](const auto&... f) {
+                        ((out += std::exchange(first, false) ? "" : ",", append_json_string(out, f.name), out += ':', append_json(out, v.*f.member)),
+                         ...);
+                    },
+                    T::restcl_fields());
+            out += '}';
+        }
+        else if constexpr (std::is_same_v<T, nlohmann::json>) {
+            out += v.dump();
+        }
+        else {
+            out += nlohmann::json(v).dump();
+        }
+    }
+} // namespace siddiqsoft
+
+#endif // !RESTCL_TYPED_HPP
@@ -49,6 +49,8 @@
 #include <deque>
 #include <semaphore>
 #include <stop_token>
+#include <algorithm>
+#include <limits>
 
 
 #include <windows.h>
@@ -63,21 +65,16 @@
 
 #include "nlohmann/json.hpp"
 #include "restcl.hpp"
+#include "restcl_connection_pool.hpp"
+#include "restcl_http_parser.hpp"
 
-#include "siddiqsoft/string2map.hpp"
 #include "siddiqsoft/acw32h.hpp"
 #include "siddiqsoft/conversion-utils.hpp"
 
-#include "siddiqsoft/simple_pool.hpp"
+#include "restcl_executor.hpp"
 
 namespace siddiqsoft
 {
-    struct RestPoolArgsType
-    {
-        basic_request      request;
-        basic_callbacktype callback;
-    };
-
 
 #pragma region WinInet error code map
     static std::map<uint32_t, std::string_view> WinInetErrorCodes {
@@ -228,31 +225,32 @@ namespace siddiqsoft
         static inline const char*    RESTCL_ACCEPT_TYPES[4] {"application/json", "text/json", "*/*", NULL};
         static inline const wchar_t* RESTCL_ACCEPT_TYPES_W[4] {L"application/json", L"text/json", L"*/*", NULL};
 
+        static void closeConnection(HINTERNET& h) { WinHttpCloseHandle(h); }
+
         /// @brief Shared session for the entire class. This is also used by the threadpool as it send()s the data.
         ACW32HINTERNET hSession {};
 
-        /// @brief Adds asynchrony to the library via the roundrobin_pool utility
-        simple_pool<RestPoolArgsType> pool {[&](RestPoolArgsType&& arg) -> void {
-            // This function is invoked any time we have an item
-            // The arg is moved here and belongs to use. Once this
-            // method completes the lifetime of the object ends;
-            // typically this is *after* we invoke the callback.
-            try {
-                auto resp = send(arg.request);
-                arg.callback(arg.request, resp);
-            }
-            catch (const std::exception&) {
-            }
-        }};
+        /// @brief Connection handles (WinHttpConnect) kept per origin so each send() does not re-connect.
+        /// Declared after the session so the handles are closed before the session.
+        connection_pool<HINTERNET> connections {{}, closeConnection};
+
+        /// @brief Adds asynchrony to the library: the synchronous send() runs on the work-stealing workers.
+        /// Declared after the handles so the workers stop before the handles are closed.
+        async_executor executor {*this};
 
     public:
         WinHttpRESTClient(const WinHttpRESTClient&)            = delete;
         WinHttpRESTClient& operator=(const WinHttpRESTClient&) = delete;
 
         /// @brief Move constructor. We have the object hSession which must be transferred to our instance.
+        /// The settings of the client, the limits of the connection pool and the executor options (queue bound, overflow
+        /// policy and lanes) are carried over; the pooled connections and the queued requests remain with the source.
         /// @param src Source object is "cleared"
         WinHttpRESTClient(WinHttpRESTClient&& src) noexcept
-            : hSession(std::move(src.hSession))
+            : basic_restclient(std::move(src))
+            , hSession(std::move(src.hSession))
+            , connections(src.connections.limits(), closeConnection)
+            , executor(*this, src.executor.limits())
         {
             // If the source is null/empty then we should create our own instance!
             if (hSession == NULL) {
@@ -283,7 +281,9 @@ namespace siddiqsoft
         /// @brief Creates the Windows REST Client with given UserAgent string
         /// Sets the HTTP/2 option and the decompression options
         /// @param ua User agent string; defaults to `siddiqsoft.restcl_winhttp/1.6 (Windows NT; x64)`
-        WinHttpRESTClient(const std::string& ua = "siddiqsoft.restcl_winhttp/1.6 (Windows NT; x64)")
+        /// @param asyncOptions Workers and queue bounds of the asynchronous send()
+        WinHttpRESTClient(const std::string& ua = "siddiqsoft.restcl_winhttp/1.6 (Windows NT; x64)", const executor_options& asyncOptions = {})
+            : executor(*this, asyncOptions)
         {
             UserAgent  = ua;
             UserAgentW = ConversionUtils::convert_to<char,wchar_t>(ua);
@@ -312,12 +312,20 @@ namespace siddiqsoft
         }
 
 
+        /// @brief The options the asynchronous executor was built with (carried over by the move constructor)
+        const executor_options& asyncOptions() const { return executor.limits(); }
+
+
+        /// @brief The typed send<T>() overloads of basic_restclient
+        using basic_restclient::send;
+
+
         /// @brief Implements an asynchronous invocation of the send() method
         /// @param req Request object
         /// @param callback The method will be async and there will not be a response object returned
         void send(basic_request&& req, basic_callbacktype& callback)
         {
-            pool.queue(RestPoolArgsType {.request = std::move(req), .callback = callback});
+            executor.submit(std::move(req), [callback](basic_request&& q, basic_response&& r) { callback(q, r); });
         }
 
 
@@ -326,7 +334,7 @@ namespace siddiqsoft
         /// @param callback The method will be async and there will not be a response object returned
         void send(basic_request&& req, basic_callbacktype&& callback)
         {
-            pool.queue(RestPoolArgsType {.request = std::move(req), .callback = std::move(callback)});
+            executor.submit(std::move(req), [callback = std::move(callback)](basic_request&& q, basic_response&& r) { callback(q, r); });
         }
 
 
@@ -342,22 +350,20 @@ namespace siddiqsoft
             /// @param src The buffer as wstring
             /// @return A tuple with httpVersion, statusCode, reasonPhrase and the last is the offset to the start of the header
             /// section just past the end of the response line.
-            auto extractResponseLine = [](const std::wstring& src) -> std::tuple<std::string, uint32_t, std::string, size_t> {
-                // Given the first line is of the format: `HTTP_VERSION STATUS_CODE REASON_PHRASE\r\n`
-                // Return the particles.
-
-                // TODO: Optimize..
-                auto firstPart    = src.find_first_of(L' ');
-                auto httpVersion  = src.substr(0, firstPart);
-                auto secondPart   = src.find_first_of(L' ', ++firstPart);
-                auto statusCode   = src.substr(firstPart, secondPart - firstPart);
-                auto lastPart     = src.find_first_of(L"\r\n", ++secondPart);
-                auto reasonPhrase = src.substr(secondPart, lastPart - secondPart);
-
-                return {ConversionUtils::convert_to<wchar_t,char>(httpVersion),
-                        std::stoi(statusCode),
-                        ConversionUtils::convert_to<wchar_t,char>(reasonPhrase),
-                        lastPart + 2}; // start of the header section
+            /// @brief Receives the status line and headers from the http_response_parser
+            struct head_reader
+            {
+                basic_response& resp;
+
+                void on_status(std::string_view version, uint32_t status, std::string_view reason)
+                {
+                    resp["response"]["version"] = version;
+                    resp["response"]["status"]  = status;
+                    resp["response"]["reason"]  = reason;
+                }
+                void on_header(std::string_view name, std::string_view value) { resp.headers().receive(name, value); }
+                void on_headers_complete() { }
+                void on_body(std::string_view) { }
             };
 
             HRESULT  hr {E_FAIL};
@@ -365,12 +371,20 @@ namespace siddiqsoft
             uint32_t nRetry {0}, nError {0};
             char     cBuf[READBUFFERSIZE] {};
             DWORD    dwFlagsSize = 0;
-            auto&    hs          = req["headers"]; // shortcut
-            auto&    rs          = req["request"]; // shortcut
+            auto&    hs          = req.headers(); // shortcut
+            auto&    rs          = std::as_const(req)["request"]; // shortcut
+
+            // WinHTTP is used synchronously; a stop is observed between its calls
+            auto& stop      = req.getStopToken();
+            auto  cancelled = [] { return rest_response {restcl_status::Cancelled, "The request was cancelled"}; };
+            if (stop.stop_requested()) return cancelled();
+            if (req.expired()) return rest_response {restcl_status::Timeout, "The deadline passed before the request was sent"};
 
             // First order - adjust the UserAgent
-            if (!hs.contains("User-Agent")) req["headers"]["User-Agent"] = UserAgent;
-            auto strUserAgent = hs.contains("User-Agent") ? hs.value("User-Agent", UserAgent) : UserAgent;
+            if (!hs.contains("User-Agent")) hs.set("User-Agent", UserAgent);
+            if (!SendDate) hs.erase("Date");
+            stampDeadline(req);
+            auto strUserAgent = std::string(hs.value("User-Agent", UserAgent));
 
             if (hSession != NULL) {
                 const DWORD enableHTTP2Flag = WINHTTP_PROTOCOL_FLAG_HTTP2;
@@ -393,10 +407,21 @@ namespace siddiqsoft
                 }
 
                 auto& strServer = req.uri.authority.host;
-                if (ACW32HINTERNET hConnect {
-                            WinHttpConnect(hSession, ConversionUtils::convert_to<char,wchar_t>(strServer).c_str(), req.uri.authority.port, 0)};
-                    hConnect != NULL)
-                {
+                auto  connect   = [&]() -> std::optional<HINTERNET> {
+                    if (HINTERNET h = WinHttpConnect(
+                                hSession, ConversionUtils::convert_to<char, wchar_t>(strServer).c_str(), req.uri.authority.port, 0);
+                        h != NULL)
+                        return h;
+                    return std::nullopt;
+                };
+
+                // Reuse the connection handle for the origin; beyond the pool limits we use an unpooled handle.
+                auto* origin = connections.origin(connection_pool<HINTERNET>::key(req.uri.scheme, strServer, req.uri.authority.port));
+                auto  pooled = origin != nullptr ? connections.acquire(*origin, connect) : connection_pool<HINTERNET>::lease {};
+                ACW32HINTERNET transient {};
+                if (!pooled) transient = connect().value_or(NULL);
+
+                if (HINTERNET hConnect = pooled ? pooled.get() : static_cast<HINTERNET>(transient); hConnect != NULL) {
                     auto strMethod  = rs.value("method", "");
                     auto strUrl     = req.uri.urlPart;
                     auto strVersion = rs.value("version", "");
@@ -412,7 +437,30 @@ namespace siddiqsoft
                                                                             : WINHTTP_FLAG_REFRESH)};
                         hRequest != NULL)
                     {
-                        auto        contentLength = hs.value("Content-Length", 0);
+                        // The phase limits and the remaining budget bound the resolve, connect, send (which includes the TLS
+                        // handshake) and each receive of this request; unset phases keep the WinHTTP defaults
+                        if (auto& limits = req.getTimeouts(); req.hasDeadline() || limits.total.count() > 0 ||
+                                                              limits.connect.count() > 0 || limits.tls.count() > 0 ||
+                                                              limits.firstByte.count() > 0)
+                        {
+                            auto budget = req.remaining();
+                            if (limits.total.count() > 0) budget = (std::min)(budget, limits.total);
+                            auto bound = [&](std::chrono::milliseconds phase, int def) -> int {
+                                auto ms = phase.count() > 0 ? (std::min)(phase, budget) : budget;
+                                if (ms == std::chrono::milliseconds::max()) return def;
+                                return static_cast<int>(std::clamp<int64_t>(ms.count(), 1, (std::numeric_limits<int>::max)()));
+                            };
+                            WinHttpSetTimeouts(hRequest,
+                                               bound({}, 0),
+                                               bound(limits.connect, 60000),
+                                               bound(limits.tls, 30000),
+                                               bound(limits.firstByte, 30000));
+                        }
+
+                        // The body is referenced, not copied; json content is serialized into contentScratch
+                        std::string contentScratch;
+                        auto        content       = req.getContent(contentScratch);
+                        auto        contentLength = static_cast<DWORD>(content.length());
                         std::string strHeaders;
                         req.encodeHeaders_to(strHeaders);
                         std::wstring requestHeaders = ConversionUtils::convert_to<char,wchar_t>(strHeaders);
@@ -422,11 +470,12 @@ namespace siddiqsoft
                                                           WINHTTP_ADDREQ_FLAG_ADD);
 
                         dwError                     = ERROR_SUCCESS;
+                        if (stop.stop_requested()) return cancelled();
                         // Send the request
                         nError = WinHttpSendRequest(hRequest,
                                                     WINHTTP_NO_ADDITIONAL_HEADERS,
                                                     0,
-                                                    contentLength > 0 ? LPVOID(req.getContent().c_str()) : NULL,
+                                                    contentLength > 0 ? LPVOID(content.data()) : NULL,
                                                     contentLength,
                                                     contentLength,
                                                     NULL);
@@ -438,7 +487,7 @@ namespace siddiqsoft
                                 nError = WinHttpSendRequest(hRequest,
                                                             WINHTTP_NO_ADDITIONAL_HEADERS,
                                                             0,
-                                                            contentLength > 0 ? LPVOID(req.getContent().c_str()) : NULL,
+                                                            contentLength > 0 ? LPVOID(content.data()) : NULL,
                                                             contentLength,
                                                             contentLength,
                                                             NULL);
@@ -489,23 +538,14 @@ namespace siddiqsoft
                                     if (nError == TRUE && (lpOutBuffer != nullptr)) {
                                         // The data is wchar_t but the dwSize returns bytes; adjustmend required.
                                         dwSize /= sizeof(wchar_t);
-                                        // We need to skip the first line of the respose as it is the status response line.
-                                        // Decode the CRLF string into key-value elements.
-                                        std::wstring src {lpOutBuffer.get(), dwSize};
-
-                                        size_t startOfHeaders    = std::string::npos;
-                                        std::tie(resp["response"]["version"],
-                                                 resp["response"]["status"],
-                                                 resp["response"]["reason"],
-                                                 startOfHeaders) = extractResponseLine(src);
-                                        src.erase(0, startOfHeaders);
-
-                                        // Parse the response into json object..
-                                        // Extract the heads into a map<string,string> where the source is wstring and the
-                                        // output is string This is then fed to the json which will create a headers object.
-                                        resp["headers"] =
-                                                string2map::parse<std::wstring, std::string, std::map<std::string, std::string>>(
-                                                        src, L": ", L"\r\n");
+                                        // The raw headers (status line included) are parsed by the same parser the
+                                        // other clients use; WinHTTP has already removed the transfer coding so the
+                                        // block is parsed as the head of a response without a body.
+                                        auto src = ConversionUtils::convert_to<wchar_t, char>(std::wstring {lpOutBuffer.get(), dwSize});
+                                        http_response_parser parser {};
+                                        head_reader          reader {resp};
+                                        parser.set_head_request(true);
+                                        parser.parse(src, reader);
                                     }
                                 }
                             }
@@ -525,6 +565,9 @@ namespace siddiqsoft
                         else if (dwError == ERROR_WINHTTP_INVALID_URL) {
                             return rest_response {static_cast<int>(dwError), messageFromWininetCode(dwError)};
                         }
+                        else if (stop.stop_requested()) {
+                            return cancelled();
+                        }
                         else if (dwError != ERROR_FILE_NOT_FOUND) {
                             nRetry = 0;
                             // while (dwError == ERROR_WINHTTP_CLIENT_AUTH_CERT_NEEDED)
@@ -547,21 +590,25 @@ namespace siddiqsoft
                             //	if (nRetry > HTTPS_MAXRETRY) break;
                             //}
 
-                            std::string rawResponse {};
+                            // Json content may be streamed to the request's handler or projection as it arrives
+                            content_receiver content {};
+                            content.expect(req);
+                            content.begin(resp.headers());
 
                             do {
+                                if (stop.stop_requested()) return cancelled();
                                 // Returns byte stream; accumulate until we're out of data.
                                 hr = WinHttpReadData(hRequest, cBuf, READBUFFERSIZE - 1, &dwBytesRead)
                                            ? S_OK
                                            : HRESULT_FROM_WIN32(GetLastError());
                                 if (dwBytesRead) {
                                     cBuf[dwBytesRead] = '\0';
-                                    rawResponse.append(cBuf, dwBytesRead);
+                                    content.append({cBuf, dwBytesRead});
                                 }
                             } while (dwBytesRead > 0);
 
                             hr = S_OK;
-                            resp.setContent(rawResponse);
+                            content.end(resp);
 
                             // Invoke the callback
                             return resp;
@@ -582,6 +629,13 @@ namespace siddiqsoft
                 return rest_response {hr, std::format("WinHttpOpen() failed; dwError:{}", hr)};
             }
         }
+
+    protected:
+        /// @brief The executor hands the request and the response to the callback by move
+        void dispatch(basic_request&& req, basic_movecallbacktype&& callback) override
+        {
+            executor.submit(std::move(req), std::move(callback));
+        }
     };
 } // namespace siddiqsoft
 
@@ -36,11 +36,20 @@
 #include "gtest/gtest.h"
 #include <iostream>
 #include <barrier>
+#include <thread>
 #include <version>
+#include <map>
+#include <optional>
 
 #include "nlohmann/json.hpp"
 #include "../include/siddiqsoft/restcl.hpp"
+#include "../include/siddiqsoft/restcl_connection_pool.hpp"
+#include "../include/siddiqsoft/restcl_http_parser.hpp"
+#include "../include/siddiqsoft/restcl_executor.hpp"
+#include "../include/siddiqsoft/restcl_timer_wheel.hpp"
+#if defined(_WIN32)
 #include "../include/siddiqsoft/restcl_winhttp.hpp"
+#endif
 
 #ifndef __cpp_lib_atomic_flag_test
 #pragma message("nothing to do; please update to ensure C++20 support!")
@@ -84,6 +93,971 @@ namespace siddiqsoft
     }
 
 
+    TEST(Serializers, encode_to)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        auto srt = ReqPost {"https://www.siddiqsoft.com/path?q=1"_Uri, {{"X-Int", -3}, {"X-Bool", true}}, {{"foo", "bar"}}};
+
+        std::string wire;
+        auto        size = srt.encode_to(wire);
+        EXPECT_EQ(srt.encode(), wire);
+        EXPECT_EQ(srt.encoded_size(), size);
+        EXPECT_EQ(wire.length(), size);
+        EXPECT_TRUE(wire.starts_with("POST /path?q=1 HTTP/2\r\n"));
+        EXPECT_TRUE(wire.find("X-Int: -3\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.find("X-Bool: true\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.ends_with("\r\n\r\n{\"foo\":\"bar\"}"));
+
+        // Re-using the buffer does not re-allocate
+        auto capacity = wire.capacity();
+        auto data     = wire.data();
+        srt.encode_to(wire);
+        EXPECT_EQ(capacity, wire.capacity());
+        EXPECT_EQ(data, wire.data());
+
+        std::vector<char> vec;
+        srt.encode_to(vec);
+        EXPECT_EQ(wire, std::string(vec.data(), vec.size()));
+
+        // Too small
+        char small[8];
+        EXPECT_EQ(0, srt.encode_to(std::span<char>(small)));
+    }
+
+
+    TEST(Serializers, encode_head_to)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        // String content is not copied into the head
+        auto srt = ReqPost {"https://www.siddiqsoft.com/"_Uri};
+        srt.setContent("text/plain", std::string("hello world"));
+
+        std::string head;
+        auto        body = srt.encode_head_to(head);
+        EXPECT_TRUE(head.ends_with("\r\n\r\n"));
+        EXPECT_EQ(11, body.size());
+        EXPECT_EQ(srt.encode(), head + std::string(reinterpret_cast<const char*>(body.data()), body.size()));
+
+        // Borrowed bytes
+        const char raw[] = "borrowed";
+        srt.setContent("application/octet-stream", std::as_bytes(std::span(raw, 8)));
+        body = srt.encode_head_to(head);
+        EXPECT_EQ(reinterpret_cast<const std::byte*>(raw), body.data());
+        EXPECT_TRUE(srt["content"].is_null());
+        EXPECT_TRUE(srt.encode().find("Content-Length: 8\r\nContent-Type: application/octet-stream\r\n") != std::string::npos);
+        EXPECT_TRUE(srt.encode().ends_with("\r\n\r\nborrowed"));
+
+        // Shared buffer is referenced by every request
+        auto shared = std::make_shared<const std::string>("shared");
+        auto r2     = ReqPost {"https://www.siddiqsoft.com/"_Uri};
+        srt.setContent("text/plain", shared);
+        r2.setContent("text/plain", shared);
+        EXPECT_EQ(reinterpret_cast<const std::byte*>(shared->data()), srt.encode_head_to(head).data());
+        EXPECT_EQ(reinterpret_cast<const std::byte*>(shared->data()), r2.encode_head_to(head).data());
+        EXPECT_TRUE(r2.encode().ends_with("\r\n\r\nshared"));
+
+        // Json content is serialized once and referenced
+        srt.setContent(nlohmann::json {{"foo", "bar"}});
+        body = srt.encode_head_to(head);
+        EXPECT_EQ(13, body.size());
+        EXPECT_EQ(body.data(), srt.encode_head_to(head).data());
+        EXPECT_EQ(srt.encode(), head + std::string(reinterpret_cast<const char*>(body.data()), body.size()));
+    }
+
+
+    TEST(Serializers, json_content_cache)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        auto srt = ReqPost {"https://www.siddiqsoft.com/"_Uri, nullptr, {{"foo", "bar"}}};
+        EXPECT_EQ("{\"foo\":\"bar\"}", srt.getContent());
+        EXPECT_EQ(13, srt["headers"].value("Content-Length", 0));
+
+        // Reading the headers does not discard the cached content
+        std::string scratch;
+        auto        cached = srt.getContent(scratch);
+        srt["headers"]["X-Extra"] = "1";
+        EXPECT_EQ(cached.data(), srt.getContent(scratch).data());
+        EXPECT_TRUE(scratch.empty());
+
+        // Modifying the content is reflected in the output
+        srt["content"]["foo"] = "baz";
+        EXPECT_EQ("{\"foo\":\"baz\"}", srt.getContent());
+        EXPECT_TRUE(srt.encode().ends_with("\r\n\r\n{\"foo\":\"baz\"}"));
+
+        srt[nlohmann::json::json_pointer("/content/foo")] = "qux";
+        EXPECT_EQ("{\"foo\":\"qux\"}", srt.getContent());
+
+        // String content replaces the json
+        srt.setContent("text/plain", std::string("plain"));
+        EXPECT_EQ("plain", srt.getContent());
+    }
+
+
+    TEST(Serializers, request_line)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        static_assert(to_string_view(RESTMethodType::Options) == "OPTIONS");
+        static_assert(to_string_view(HTTPProtocolVersion::Http11) == "HTTP/1.1");
+        static_assert(std::string_view(request_line_prefix<RESTMethodType::Delete>.data(), 7) == "DELETE ");
+        EXPECT_EQ("PATCH HTTP/1.0", std::format("{} {}", RESTMethodType::Patch, HTTPProtocolVersion::Http10));
+
+        auto srt = rest_request<RESTMethodType::Put, HTTPProtocolVersion::Http11> {"https://www.siddiqsoft.com/a/b"_Uri};
+        EXPECT_EQ("PUT", srt["request"].value("method", ""));
+        EXPECT_TRUE(srt.encode().starts_with("PUT /a/b HTTP/1.1\r\n"));
+
+        srt.setProtocol(HTTPProtocolVersion::Http10);
+        EXPECT_EQ("HTTP/1.0", srt["request"].value("version", ""));
+        EXPECT_TRUE(srt.encode().starts_with("PUT /a/b HTTP/1.0\r\n"));
+
+        // Modifying the request line via the json is honored
+        srt["request"]["method"] = "POST";
+        EXPECT_TRUE(srt.encode().starts_with("POST /a/b HTTP/1.0\r\n"));
+        EXPECT_EQ(srt.encode().length(), srt.encoded_size());
+        srt.setProtocol(HTTPProtocolVersion::Http2);
+        EXPECT_TRUE(srt.encode().starts_with("POST /a/b HTTP/2\r\n"));
+    }
+
+
+    TEST(Serializers, response_encode_to)
+    {
+        rest_response resp {200, "OK"};
+        resp["headers"] = {{"Content-Type", "application/json"}, {"Content-Length", 13}};
+        resp["content"] = {{"hello", "w"}};
+
+        std::string wire;
+        EXPECT_EQ(resp.encoded_size(), resp.encode_to(wire));
+        EXPECT_EQ("HTTP/2 200 OK\r\nContent-Length: 13\r\nContent-Type: application/json\r\n\r\n{\"hello\":\"w\"}", wire);
+        EXPECT_EQ(wire, resp.encode());
+    }
+
+
+    TEST(Headers, store)
+    {
+        http_headers hs;
+        hs.set("Content-Type", "application/json").set("Content-Length", 13u).set("X-Signed", -3).set("X-Bool", true);
+
+        EXPECT_EQ(4, hs.size());
+        EXPECT_TRUE(hs.contains("content-type"));
+        EXPECT_EQ("13", hs.value("CONTENT-LENGTH"));
+        EXPECT_EQ("fallback", hs.value("X-Missing", "fallback"));
+
+        // Replace retains the original spelling and position
+        hs.set("content-type", "text/plain");
+        std::string wire;
+        hs.for_each([&](std::string_view k, std::string_view v) { wire.append(k).append(": ").append(v).append("\r\n"); });
+        EXPECT_EQ("Content-Type: text/plain\r\nContent-Length: 13\r\nX-Signed: -3\r\nX-Bool: true\r\n", wire);
+
+        // Json view keeps the types
+        auto& doc = std::as_const(hs).json();
+        EXPECT_EQ(13, doc.value("Content-Length", 0));
+        EXPECT_EQ(-3, doc.value("X-Signed", 0));
+        EXPECT_TRUE(doc.value("X-Bool", false));
+
+        // Repeated headers are folded
+        hs.append("Accept", "text/html").append("accept", "application/json");
+        EXPECT_EQ("text/html, application/json", hs.value("Accept"));
+
+        EXPECT_TRUE(hs.erase("X-SIGNED"));
+        EXPECT_FALSE(hs.erase("X-Signed"));
+        EXPECT_EQ(4, hs.size());
+
+        // Spill beyond the inline storage
+        for (size_t i = 0; i < http_headers::INLINE_CAPACITY * 2; i++) hs.set(std::format("X-{}", i), i);
+        EXPECT_EQ(4 + http_headers::INLINE_CAPACITY * 2, hs.size());
+        EXPECT_EQ("23", hs.value("x-23"));
+        EXPECT_TRUE(hs.erase("Content-Type"));
+        EXPECT_EQ("23", hs.value("x-23"));
+        hs.clear();
+        EXPECT_TRUE(hs.empty());
+    }
+
+
+    TEST(Headers, json_view)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        auto srt = ReqGet {"https://www.siddiqsoft.com/"_Uri, {{"X-Int", -3}}};
+        EXPECT_EQ(-3, srt["headers"].value("X-Int", 0));
+        EXPECT_EQ("application/json", srt[nlohmann::json::json_pointer("/headers/Accept")].get<std::string>());
+
+        // Changes made via the json view are used by the encoder and the store
+        srt["headers"]["X-View"] = "1";
+        srt["headers"].erase("Accept");
+        EXPECT_EQ("1", srt.headers().value("X-View"));
+        EXPECT_FALSE(srt.headers().contains("Accept"));
+        auto wire = srt.encode();
+        EXPECT_TRUE(wire.find("X-View: 1\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.find("Accept:") == std::string::npos);
+
+        // Changes made to the store are visible in the json view
+        srt.headers().set("X-Store", 2);
+        EXPECT_EQ(2, srt["headers"].value("X-Store", 0));
+
+        nlohmann::json doc = srt;
+        EXPECT_EQ("1", doc["rrd"]["headers"].value("X-View", ""));
+
+        // Responses round-trip through json
+        rest_response resp {200, "OK"};
+        resp.headers().set("Content-Type", "text/plain").set("Content-Length", 5);
+        nlohmann::json rdoc = resp;
+        auto           copy = rdoc.get<rest_response>();
+        EXPECT_EQ("5", copy.headers().value("content-length"));
+        EXPECT_EQ(rdoc, nlohmann::json(copy));
+    }
+
+
+    TEST(Headers, received_block)
+    {
+        EXPECT_EQ(known_header::ContentType, to_known_header("content-type"));
+        EXPECT_EQ(known_header::ETag, to_known_header("ETAG"));
+        EXPECT_EQ(known_header::Other, to_known_header("Content-Typo"));
+        EXPECT_EQ(known_header::Other, to_known_header("Date"));
+
+        rest_response resp {200, "OK"};
+        resp.headers().receive("Content-Type", "application/json").receive("ETag", "\"v1\"").receive("X-Trace", "a:b");
+        resp.headers().receive("Retry-After", "120");
+
+        const auto& hs = resp.headers();
+        EXPECT_EQ(4, hs.size());
+        EXPECT_EQ("application/json", hs.value(known_header::ContentType));
+        EXPECT_EQ("\"v1\"", hs.value("etag"));
+        EXPECT_EQ("120", hs.value(known_header::RetryAfter));
+        EXPECT_EQ("a:b", hs.value("x-trace"));
+        EXPECT_FALSE(hs.contains(known_header::ContentLength));
+        EXPECT_EQ("none", hs.value(known_header::ContentLength, "none"));
+
+        // The wire form is the received block as-is
+        std::string wire;
+        hs.for_each_wire([&](std::string_view part) { wire.append(part); });
+        EXPECT_EQ("Content-Type: application/json\r\nETag: \"v1\"\r\nX-Trace: a:b\r\nRetry-After: 120\r\n", wire);
+
+        // The json view is built on demand
+        EXPECT_EQ("a:b", resp["headers"].value("X-Trace", ""));
+        EXPECT_EQ(4, resp["headers"].size());
+
+        // Modifying the store converts the block into entries
+        resp.headers().set("Retry-After", 5);
+        EXPECT_EQ("5", resp.headers().value(known_header::RetryAfter));
+        EXPECT_EQ("\"v1\"", resp.headers().value("ETag"));
+        EXPECT_EQ(4, resp.headers().size());
+
+        // Repeated headers are folded
+        http_headers repeated;
+        repeated.receive("Set-Cookie", "a=1").receive("Vary", "Accept").receive("set-cookie", "b=2");
+        EXPECT_EQ("a=1, b=2", repeated.value("Set-Cookie"));
+        EXPECT_EQ(2, repeated.size());
+        EXPECT_EQ("a=1, b=2", repeated.json().value("Set-Cookie", ""));
+
+        // Any number of headers, repeats included, stays one indexed block
+        http_headers many;
+        for (int i = 0; i < 20; i++) many.receive("X-" + std::to_string(i), std::to_string(i));
+        many.receive("Vary", "Accept").receive("Content-Length", "2").receive("vary", "Origin").receive("VARY", "Cookie");
+        EXPECT_EQ(22, many.size());
+        EXPECT_EQ("17", many.value("x-17"));
+        EXPECT_EQ("2", many.value(known_header::ContentLength));
+        EXPECT_EQ("Accept, Origin, Cookie", many.value("Vary"));
+
+        // Lookups leave the block as-is: views returned earlier remain valid
+        const auto& cmany  = many;
+        auto        vary   = cmany.value("vary");
+        auto        length = cmany.find("content-length");
+        ASSERT_TRUE(length.has_value());
+        EXPECT_EQ("Content-Length", length->name);
+        EXPECT_EQ("2", length->value);
+        EXPECT_EQ("Accept, Origin, Cookie", cmany.find("VARY")->value);
+        EXPECT_FALSE(cmany.find("X-Absent").has_value());
+        EXPECT_EQ("Accept, Origin, Cookie", vary);
+
+        // Interleaved repeats
+        http_headers interleaved;
+        interleaved.receive("A", "1").receive("B", "1").receive("a", "2").receive("b", "2").receive("A", "3");
+        EXPECT_EQ("1, 2, 3", interleaved.value("a"));
+        EXPECT_EQ("1, 2", interleaved.value("b"));
+        EXPECT_EQ(2, interleaved.size());
+        wire.clear();
+        many.for_each_wire([&](std::string_view part) { wire.append(part); });
+        EXPECT_TRUE(wire.ends_with("Vary: Accept\r\nContent-Length: 2\r\nvary: Origin\r\nVARY: Cookie\r\n"));
+        size_t visited = 0;
+        many.for_each([&](std::string_view, std::string_view) { visited++; });
+        EXPECT_EQ(22, visited);
+
+        // The store is re-used for the next response
+        many.clear();
+        many.receive("ETag", "\"v2\"");
+        EXPECT_EQ(1, many.size());
+        EXPECT_EQ("\"v2\"", many.value(known_header::ETag));
+        EXPECT_FALSE(many.contains("Vary"));
+    }
+
+
+    TEST(Headers, date_cache)
+    {
+        auto d = http_date::now();
+        EXPECT_EQ(http_date::LENGTH, d.view().length());
+        EXPECT_TRUE(d.view().ends_with(" GMT"));
+        // Unless the clock ticked over in between, the cached value matches a fresh formatting
+        auto fresh = DateUtils::RFC7231(std::chrono::system_clock::now());
+        auto again = http_date::now();
+        EXPECT_TRUE(fresh == again.view() || fresh == d.view() || again.view() != d.view());
+
+        // Concurrent readers always observe a complete value
+        std::atomic_uint bad {0};
+        {
+            std::vector<std::jthread> readers;
+            for (int t = 0; t < 4; t++) {
+                readers.emplace_back([&] {
+                    for (int i = 0; i < 20000; i++) {
+                        auto d = http_date::now();
+                        auto v = d.view();
+                        if (v.length() != http_date::LENGTH || !v.ends_with(" GMT") || v[3] != ',') bad++;
+                    }
+                });
+            }
+        }
+        EXPECT_EQ(0, bad.load());
+
+        auto srt = "https://www.siddiqsoft.com/"_GET;
+        EXPECT_EQ(http_date::LENGTH, srt.headers().value("Date").length());
+    }
+
+
+    TEST(Headers, prototype)
+    {
+        using namespace siddiqsoft::splituri_literals;
+
+        request_prototype<RESTMethodType::Post> items {"https://www.siddiqsoft.com/items"_Uri, {{"X-Api-Key", "secret"}}};
+        EXPECT_FALSE(items.headers().contains("Date"));
+
+        auto r1 = items.make("/items/1?q=x");
+        auto r2 = items.make();
+        r1.headers().set("X-Request-Id", "1");
+        r1.setContent({{"id", 1}});
+
+        EXPECT_EQ("/items/1?q=x", r1.uri.urlPart);
+        EXPECT_EQ("https://www.siddiqsoft.com/items/1?q=x", r1.uri.sourceUri);
+        EXPECT_EQ("/items", r2.uri.urlPart);
+
+        // Every part of the uri matches the parsed uri
+        auto r3     = items.make("/items/2/parts?q=x&sort=asc&flag#top");
+        auto parsed = SplitUri(std::string("https://www.siddiqsoft.com/items/2/parts?q=x&sort=asc&flag#top"));
+        EXPECT_EQ(parsed.sourceUri, r3.uri.sourceUri);
+        EXPECT_EQ(parsed.urlPart, r3.uri.urlPart);
+        EXPECT_EQ(parsed.pathPart, r3.uri.pathPart);
+        EXPECT_EQ(parsed.path, r3.uri.path);
+        EXPECT_EQ(parsed.queryPart, r3.uri.queryPart);
+        EXPECT_EQ(parsed.query, r3.uri.query);
+        EXPECT_EQ(parsed.fragment, r3.uri.fragment);
+        EXPECT_EQ("asc", r3.uri.query["sort"]);
+        EXPECT_TRUE(r1.uri.query.contains("q"));
+        EXPECT_EQ("secret", r1.headers().value("x-api-key"));
+        EXPECT_EQ(http_date::LENGTH, r2.headers().value("Date").length());
+
+        // Changes to one request are not seen by the others
+        EXPECT_FALSE(r2.headers().contains("X-Request-Id"));
+        EXPECT_EQ("0", r2.headers().value("Content-Length"));
+        EXPECT_EQ("8", r1.headers().value("Content-Length"));
+
+        auto wire = r1.encode();
+        EXPECT_EQ(r1.encoded_size(), wire.length());
+        EXPECT_TRUE(wire.starts_with("POST /items/1?q=x HTTP/2\r\n"));
+        EXPECT_TRUE(wire.find("X-Api-Key: secret\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.find("X-Request-Id: 1\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.find("Content-Length: 8\r\n") != std::string::npos);
+        EXPECT_TRUE(wire.find("Content-Length: 0") == std::string::npos);
+        EXPECT_TRUE(wire.ends_with("\r\n\r\n{\"id\":1}"));
+
+        // Removing a shared header copies the shared headers into the request
+        EXPECT_TRUE(r2.headers().erase("X-Api-Key"));
+        EXPECT_FALSE(r2.headers().contains("X-Api-Key"));
+        EXPECT_TRUE(items.make().headers().contains("X-Api-Key"));
+        EXPECT_EQ(r2["headers"].size(), r2.headers().size());
+        EXPECT_EQ(r1["headers"].size(), r1.headers().size());
+    }
+
+
+    TEST(Validate, static_uri)
+    {
+        constexpr auto& u = static_uri_parser<"http://user@api.siddiqsoft.com:8080?q=1">::value;
+        static_assert(u.scheme == UriScheme::WebHttp);
+        static_assert(u.host == "api.siddiqsoft.com");
+        static_assert(u.port == 8080);
+        static_assert(u.hostHeader == "api.siddiqsoft.com:8080");
+        static_assert(u.urlPart == "/?q=1");
+        static_assert(static_uri_parser<"https://[::1]/a">::value.hostHeader == "[::1]:443");
+
+        // The literal matches the request built from the parsed uri
+        auto r1 = "https://time.akamai.com/?iso"_GET;
+        auto r2 = ReqGet {SplitUri(std::string("https://time.akamai.com/?iso"))};
+        EXPECT_EQ(r2.uri.authority.host, r1.uri.authority.host);
+        EXPECT_EQ(r2.uri.authority.port, r1.uri.authority.port);
+        EXPECT_EQ(r2.uri.urlPart, r1.uri.urlPart);
+        EXPECT_EQ(r2.headers().value("Host"), r1.headers().value("Host"));
+        EXPECT_EQ(r2["request"], r1["request"]);
+        EXPECT_TRUE(r1.encode().starts_with("GET /?iso HTTP/2\r\n"));
+
+        // The path and the query are split at compile time as SplitUri splits them at runtime
+        constexpr auto& q = static_uri_parser<"https://api.siddiqsoft.com/v1//items?id=42&sort=asc&flag#top">::value;
+        static_assert(q.components.pathPart == "/v1//items");
+        static_assert(q.components.queryPart == "id=42&sort=asc&flag");
+        static_assert(q.components.fragment == "top");
+        static_assert(q.path.size() == 2 && q.path[1] == "items");
+        static_assert(q.query.size() == 3 && q.query[2].first == "flag" && q.query[2].second.empty());
+
+        auto r3     = "https://api.siddiqsoft.com/v1//items?id=42&sort=asc&flag#top"_GET;
+        auto parsed = SplitUri(std::string("https://api.siddiqsoft.com/v1//items?id=42&sort=asc&flag#top"));
+        EXPECT_EQ(parsed.sourceUri, r3.uri.sourceUri);
+        EXPECT_EQ(parsed.urlPart, r3.uri.urlPart);
+        EXPECT_EQ(parsed.pathPart, r3.uri.pathPart);
+        EXPECT_EQ(parsed.path, r3.uri.path);
+        EXPECT_EQ(parsed.queryPart, r3.uri.queryPart);
+        EXPECT_EQ(parsed.query, r3.uri.query);
+        EXPECT_EQ(parsed.fragment, r3.uri.fragment);
+        EXPECT_EQ(r2.uri.query, r1.uri.query);
+        EXPECT_EQ(r2.uri.pathPart, r1.uri.pathPart);
+    }
+
+
+    TEST(Serializers, response_lazy_content)
+    {
+        rest_response resp {200, "OK"};
+        resp.headers().set("Content-Type", "application/json; charset=utf-8");
+        resp.setContent(std::string(R"({"hello":"world"})"));
+
+        // The body is available without building the json
+        EXPECT_EQ(R"({"hello":"world"})", resp.rawContent());
+        EXPECT_TRUE(resp.encode().ends_with("\r\n\r\n{\"hello\":\"world\"}"));
+        EXPECT_EQ("17", resp.headers().value("Content-Length"));
+
+        // Parsed on first access, including const access
+        const auto& cresp = resp;
+        EXPECT_EQ("world", cresp["content"].value("hello", ""));
+        EXPECT_EQ("world", cresp[nlohmann::json::json_pointer("/content/hello")].get<std::string>());
+        EXPECT_EQ(R"({"hello":"world"})", resp.rawContent());
+
+        // Modifying the content releases the received body
+        resp["content"]["hello"] = "there";
+        EXPECT_TRUE(resp.rawContent().empty());
+        EXPECT_TRUE(resp.encode().ends_with("{\"hello\":\"there\"}"));
+
+        // Not json: kept as a string
+        rest_response text {200, "OK"};
+        text.headers().set("Content-Type", "application/json");
+        text.setContent(std::string("not json"));
+        auto copy = text;
+        EXPECT_EQ("not json", copy["content"].get<std::string>());
+        EXPECT_EQ("not json", text.rawContent());
+    }
+
+
+    TEST(Serializers, response_lazy_content_threads)
+    {
+        for (int round = 0; round < 50; round++) {
+            rest_response resp {200, "OK"};
+            resp.headers().set("Content-Type", "application/json");
+            resp.setContent(std::format(R"({{"round":{},"items":[1,2,3,4,5,6,7,8]}})", round));
+
+            // Several threads read the same const response; the first one decodes the content and builds the header view
+            const auto&               cresp = resp;
+            std::atomic_uint          passTest {0};
+            std::barrier              start {4};
+            std::vector<std::jthread> readers;
+            for (int i = 0; i < 4; i++) {
+                readers.emplace_back([&, i] {
+                    start.arrive_and_wait();
+                    if (i == 0) {
+                        auto copy = cresp;
+                        passTest += copy["content"].value("round", -1) == round;
+                    }
+                    else {
+                        passTest += cresp["content"].value("round", -1) == round && cresp["content"]["items"].size() == 8 &&
+                                    cresp["headers"].value("Content-Type", "") == "application/json" && cresp.status().code == 200;
+                    }
+                });
+            }
+            readers.clear();
+
+            EXPECT_EQ(4, passTest.load());
+        }
+    }
+
+
+    TEST(JsonStream, chunk_split)
+    {
+        auto doc = std::string(R"( {"a":[1,-2,3.5e2,18446744073709551615,-9223372036854775808,0.25],"b":{"c":"x\"y\\z\u00e9\ud83d\ude00",)"
+                               R"("d":true,"e":false,"f":null,"g":[],"h":{}},"i":[[["deep"]]],"j":123456789012345678901234567890,"k":"\/\b\f\n\r\t"} )");
+        auto expected = nlohmann::json::parse(doc);
+
+        // Every split point, plus a byte at a time
+        for (size_t step : {size_t(1), size_t(3), size_t(7), doc.length()}) {
+            nlohmann::json                                           result;
+            nlohmann::detail::json_sax_dom_parser<nlohmann::json>    sdp(result, false);
+            json_stream_parser<decltype(sdp)>                        parser(sdp);
+            for (size_t i = 0; i < doc.length(); i += step) {
+                ASSERT_TRUE(parser.feed(std::string_view(doc).substr(i, step)));
+            }
+            ASSERT_TRUE(parser.finish());
+            EXPECT_TRUE(parser.complete());
+            EXPECT_EQ(expected, result);
+        }
+
+        // A top-level number is only complete at the end of the input
+        nlohmann::json                                        number;
+        nlohmann::detail::json_sax_dom_parser<nlohmann::json> sdp(number, false);
+        json_stream_parser<decltype(sdp)>                     parser(sdp);
+        parser.feed("4");
+        parser.feed("2");
+        EXPECT_FALSE(parser.complete());
+        EXPECT_TRUE(parser.finish());
+        EXPECT_EQ(42, number);
+
+        // Invalid documents are reported
+        for (std::string_view bad : {R"({"a":1,})", R"([1 2])", R"({"a" 1})", "[tru]", "[01]", "[1.]", R"(["\x"])",
+                                     R"(["\udc00"])", "{\"a\":1", "[\"abc", "", "1 2", "[\"\x01\"]"})
+        {
+            nlohmann::json                                        r;
+            nlohmann::detail::json_sax_dom_parser<nlohmann::json> handler(r, false);
+            json_stream_parser<decltype(handler)>                 p(handler);
+            p.feed(bad);
+            EXPECT_FALSE(p.finish());
+            EXPECT_TRUE(p.error());
+        }
+    }
+
+
+    TEST(JsonStream, pointer_collector)
+    {
+        std::string doc = R"({"id":"42","etag":"W/1","items":[{"status":"ok","blob":[1,2,3]},{"status":"bad"}],)"
+                          R"("meta":{"a/b":{"n":1},"7":true},"tail":[1,2,3]})";
+
+        json_pointer_collector collector({nlohmann::json::json_pointer("/id"),
+                                          nlohmann::json::json_pointer("/items/1/status"),
+                                          nlohmann::json::json_pointer("/meta/a~1b"),
+                                          nlohmann::json::json_pointer("/meta/a~1b/n"), // within /meta/a~1b
+                                          nlohmann::json::json_pointer("/meta/7")});
+        json_stream_parser<> parser(collector);
+        for (size_t i = 0; i < doc.length(); i += 5) {
+            if (!parser.feed(std::string_view(doc).substr(i, 5))) break;
+        }
+
+        // The parse stops once every pointer is found; "tail" is never seen
+        EXPECT_TRUE(collector.complete());
+        EXPECT_TRUE(parser.stopped());
+        EXPECT_FALSE(parser.error());
+        EXPECT_LT(parser.position(), doc.length());
+        EXPECT_EQ(nlohmann::json::parse(R"({"id":"42","items":[null,{"status":"bad"}],"meta":{"a/b":{"n":1},"7":true}})"),
+                  collector.result());
+
+        // Pointers which are absent
+        json_pointer_collector missing({nlohmann::json::json_pointer("/nope"), nlohmann::json::json_pointer("/etag")});
+        json_stream_parser<>   p2(missing);
+        p2.feed(doc);
+        EXPECT_TRUE(p2.finish());
+        EXPECT_FALSE(missing.complete());
+        EXPECT_EQ(nlohmann::json({{"etag", "W/1"}}), missing.result());
+
+        // A nested pointer between siblings must not hide the pointers after it
+        json_pointer_collector nested({nlohmann::json::json_pointer("/a"),
+                                       nlohmann::json::json_pointer("/a/b"),
+                                       nlohmann::json::json_pointer("/c"),
+                                       nlohmann::json::json_pointer("/d")});
+        json_stream_parser<>   p3(nested);
+        p3.feed(R"({"a":{"b":1},"c":2,"d":3})");
+        EXPECT_TRUE(nested.complete());
+        EXPECT_EQ(nlohmann::json::parse(R"({"a":{"b":1},"c":2,"d":3})"), nested.result());
+    }
+
+
+    TEST(JsonStream, projection)
+    {
+        rest_request<RESTMethodType::Get> req {"https://www.siddiqsoft.com/list"};
+        req.project({"/id", "/etag", "/items/0/status"});
+        ASSERT_TRUE(req.getProjection());
+        EXPECT_EQ(3, req.getProjection()->size());
+
+        std::string body = R"({"id":7,"items":[{"status":"ok","big":[1,2,3,4]},{"status":"no"}],"etag":"\"e1\"","rest":"x"})";
+
+        // Json content: only the projection is decoded
+        rest_response   resp {200, "OK"};
+        content_receiver receiver {};
+        resp.headers().set("Content-Type", "application/json");
+        receiver.expect(req);
+        receiver.begin(resp.headers());
+        for (size_t i = 0; i < body.length(); i += 4) receiver.append(std::string_view(body).substr(i, 4));
+        receiver.end(resp);
+        EXPECT_EQ(nlohmann::json::parse(R"({"id":7,"items":[{"status":"ok"}],"etag":"\"e1\""})"), resp["content"]);
+        EXPECT_TRUE(resp.rawContent().empty());
+
+        // Other content is received as-is
+        rest_response   text {200, "OK"};
+        content_receiver r2 {};
+        text.headers().set("Content-Type", "text/plain");
+        r2.expect(req);
+        r2.begin(text.headers());
+        r2.append(body);
+        r2.end(text);
+        EXPECT_EQ(body, text.rawContent());
+
+        req.project(std::vector<nlohmann::json::json_pointer> {});
+        EXPECT_FALSE(req.getProjection());
+    }
+
+
+    struct typed_item
+    {
+        std::string status {};
+        int         code {0};
+        RESTCL_DEFINE_TYPE_INTRUSIVE(typed_item, status, code)
+    };
+
+    struct typed_list
+    {
+        uint64_t                   id {0};
+        std::string                etag {};
+        double                     ratio {0};
+        bool                       more {false};
+        std::vector<typed_item>    items {};
+        std::map<std::string, int> counts {}; // decoded via json
+        std::vector<std::string>   tags {};
+        RESTCL_DEFINE_TYPE_INTRUSIVE(typed_list, id, etag, ratio, more, items, counts, tags)
+    };
+
+
+    TEST(JsonStream, struct_decoder)
+    {
+        std::string body = R"({"id":18446744073709551615,"unknown":{"a":[1,{"b":2}]},"etag":"e\"1","ratio":0.5,"more":true,)"
+                           R"("items":[{"status":"ok","code":1,"extra":[]},{"status":"no"}],"counts":{"x":1,"y":2},"tags":["a","b"]})";
+
+        struct_decoder<typed_list> decoder;
+        json_stream_parser<>       parser(decoder);
+        for (size_t i = 0; i < body.length(); i += 3) parser.feed(std::string_view(body).substr(i, 3));
+        ASSERT_TRUE(parser.finish());
+        ASSERT_TRUE(decoder.valid());
+
+        // Same as going through the json
+        auto& r = decoder.result();
+        auto expected = nlohmann::json::parse(body);
+        expected.erase("unknown");
+        expected["items"][0].erase("extra");
+        expected["items"][1]["code"] = 0; // absent members keep their default
+        EXPECT_EQ(expected, nlohmann::json(r));
+        EXPECT_EQ("e\"1", r.etag);
+        EXPECT_EQ(2, r.counts["y"]);
+
+        // Optionals
+        struct_decoder<std::vector<std::optional<int>>> opts;
+        json_stream_parser<>                            p2(opts);
+        p2.feed("[1,null,3]");
+        ASSERT_TRUE(p2.finish());
+        ASSERT_TRUE(opts.valid());
+        EXPECT_EQ((std::vector<std::optional<int>> {1, std::nullopt, 3}), opts.result());
+
+        // Type mismatch
+        struct_decoder<typed_list> bad;
+        json_stream_parser<>       p3(bad);
+        p3.feed(R"({"id":1,"items":[{"status":5}]})");
+        p3.finish();
+        EXPECT_FALSE(bad.valid());
+        EXPECT_EQ("unexpected number for \"status\"", bad.error());
+    }
+
+
+    TEST(Serializers, struct_content)
+    {
+        typed_list list {.id = 7, .etag = "\"q\"\n", .ratio = 2, .more = true, .items = {{"ok", 1}}, .counts = {{"a", 1}}, .tags = {"x"}};
+
+        rest_request<RESTMethodType::Post> req {"https://www.siddiqsoft.com/list"};
+        req.setContent(list);
+        EXPECT_EQ("application/json", req.headers().value("Content-Type"));
+
+        std::string scratch;
+        auto        body = req.getContent(scratch);
+        EXPECT_EQ(nlohmann::json(list), nlohmann::json::parse(body));
+        EXPECT_EQ(std::to_string(body.length()), req.headers().value("Content-Length"));
+        EXPECT_TRUE(req.encode().ends_with(body));
+
+        std::string out;
+        append_json(out, std::string_view("\x01\t"));
+        EXPECT_EQ(R"("\u0001\t")", out);
+    }
+
+
+    /// @brief A list endpoint style payload of the given number of items
+    static std::string sample_list_payload(size_t count)
+    {
+        auto items = nlohmann::json::array();
+        for (size_t i = 0; i < count; i++) {
+            items.push_back({{"id", std::format("{:08x}-4b1e-9c2a-{:012x}", i, i * 7919)},
+                             {"etag", std::format("W/\"{}\"", i * 31)},
+                             {"index", i},
+                             {"balance", -1234.5678 + double(i)},
+                             {"active", i % 3 == 0},
+                             {"owner", nullptr},
+                             {"name", std::format("Item \u00e9\"{}\" \\ caf\u00e9", i)},
+                             {"tags", {"alpha", "beta", "gamma"}},
+                             {"location", {{"lat", 47.6062 + double(i) / 1000}, {"lon", -122.3321}, {"zip", "98101"}}}});
+        }
+        return nlohmann::json {{"items", items}, {"count", count}, {"next", "https://api.example.com/list?skip=100"}}.dump();
+    }
+
+
+    TEST(JsonStream, content_backend)
+    {
+        // Same values and number types as nlohmann::json::parse() whichever the backend
+        for (std::string_view doc : {R"({"a":1,"b":-1,"c":1.5,"d":"\u00e9","e":[true,false,null],"f":{"a":1,"a":2}})",
+                                     "[18446744073709551615,-9223372036854775808,123456789012345678901234567890]",
+                                     "\"text\"",
+                                     "42"})
+        {
+            auto expected = nlohmann::json::parse(doc);
+            auto actual   = parse_json_content(doc);
+            EXPECT_EQ(expected, actual);
+            EXPECT_EQ(expected.dump(), actual.dump());
+        }
+        EXPECT_EQ(nlohmann::json::parse(sample_list_payload(10)), parse_json_content(sample_list_payload(10)));
+
+        EXPECT_TRUE(parse_json_content("{\"a\":").is_discarded());
+        EXPECT_TRUE(parse_json_content("not json").is_discarded());
+    }
+
+
+    /// @brief Throughput of the content parser backends; run explicitly with --gtest_also_run_disabled_tests
+    TEST(Benchmark, DISABLED_ContentParse)
+    {
+        for (size_t count : {size_t(4), size_t(256), size_t(16384)}) {
+            auto   payload = sample_list_payload(count);
+            size_t rounds  = std::max<size_t>(1, (64u << 20) / payload.length());
+
+            auto measure = [&](auto&& parse) {
+                size_t sink  = 0;
+                auto   start = std::chrono::steady_clock::now();
+                for (size_t i = 0; i < rounds; i++) sink += parse(payload).size();
+                auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                EXPECT_GT(sink, 0);
+                return double(payload.length() * rounds) / secs / (1 << 20);
+            };
+
+            auto nl      = measure([](const std::string& s) { return nlohmann::json::parse(s); });
+            auto backend = measure([](const std::string& s) { return parse_json_content(s); });
+            std::cerr << std::format("ContentParse {:>9} bytes  nlohmann: {:8.1f} MB/s  backend{}: {:8.1f} MB/s  ({:.2f}x)\n",
+                                     payload.length(),
+                                     nl,
+#if defined(RESTCL_USE_SIMDJSON)
+                                     " (simdjson)",
+#else
+                                     " (nlohmann)",
+#endif
+                                     backend,
+                                     backend / nl);
+        }
+    }
+
+
+    /// @brief Records what the http_response_parser reports
+    struct recording_handler
+    {
+        std::string                                      version {};
+        uint32_t                                         status {0};
+        std::string                                      reason {};
+        std::vector<std::pair<std::string, std::string>> headers {};
+        std::vector<std::pair<std::string, std::string>> trailers {};
+        std::string                                      body {};
+        size_t                                           headsComplete {0};
+
+        void on_status(std::string_view v, uint32_t s, std::string_view r)
+        {
+            version = v;
+            status  = s;
+            reason  = r;
+        }
+        void on_header(std::string_view n, std::string_view v) { headers.emplace_back(n, v); }
+        void on_headers_complete() { headsComplete++; }
+        void on_body(std::string_view part) { body.append(part); }
+        void on_trailer(std::string_view n, std::string_view v) { trailers.emplace_back(n, v); }
+    };
+
+    /// @brief Parse the response fed in pieces of the given size the way a transport does
+    static bool parse_in_pieces(http_response_parser& parser, recording_handler& h, std::string_view wire, size_t step)
+    {
+        std::string pending {};
+        for (size_t i = 0; i < wire.length() && !parser.complete(); i += step) {
+            pending.append(wire.substr(i, step));
+            pending.erase(0, parser.parse(pending, h));
+            if (parser.failed()) return false;
+        }
+        return parser.complete() || parser.finish();
+    }
+
+
+    TEST(HttpParser, split_anywhere)
+    {
+        std::string_view wire = "HTTP/1.1 100 Continue\r\n\r\n"
+                                "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: gzip, chunked\r\n"
+                                "X-Empty:\r\nX-Spaces:   padded value  \r\n\r\n"
+                                "5;ext=1\r\nhello\r\n7\r\n, world\r\n0\r\nX-Checksum: abc\r\n\r\n";
+
+        for (size_t step : {size_t(1), size_t(2), size_t(5), size_t(16), wire.length()}) {
+            http_response_parser parser;
+            recording_handler    h;
+            ASSERT_TRUE(parse_in_pieces(parser, h, wire, step));
+            EXPECT_EQ("HTTP/1.1", h.version);
+            EXPECT_EQ(200, h.status);
+            EXPECT_EQ("OK", h.reason);
+            ASSERT_EQ(4, h.headers.size());
+            EXPECT_EQ("", h.headers[2].second);
+            EXPECT_EQ("padded value", h.headers[3].second);
+            EXPECT_EQ(1, h.headsComplete);
+            EXPECT_EQ("hello, world", h.body);
+            ASSERT_EQ(1, h.trailers.size());
+            EXPECT_EQ("abc", h.trailers[0].second);
+            EXPECT_TRUE(parser.keep_alive());
+        }
+    }
+
+
+    TEST(HttpParser, framing)
+    {
+        {
+            // Content-Length; the bytes of the next response are not consumed
+            std::string_view     wire = "HTTP/1.1 201 Created\r\ncontent-length: 3\r\n\r\nabcHTTP/1.1";
+            http_response_parser parser;
+            recording_handler    h;
+            EXPECT_EQ(wire.length() - 8, parser.parse(wire, h));
+            EXPECT_TRUE(parser.complete());
+            EXPECT_EQ("abc", h.body);
+        }
+        {
+            // Delimited by the close; no reason phrase and bare LF line endings
+            std::string_view     wire = "HTTP/1.0 200\nServer: x\n\npartial body";
+            http_response_parser parser;
+            recording_handler    h;
+            EXPECT_EQ(wire.length(), parser.parse(wire, h));
+            EXPECT_FALSE(parser.complete());
+            EXPECT_TRUE(parser.finish());
+            EXPECT_FALSE(parser.keep_alive());
+            EXPECT_EQ("", h.reason);
+            EXPECT_EQ("partial body", h.body);
+        }
+        {
+            // HEAD, 204 and 304 have no body
+            http_response_parser head;
+            recording_handler    h;
+            head.set_head_request(true);
+            head.parse("HTTP/1.1 200 OK\r\nContent-Length: 10\r\nConnection: close\r\n\r\n", h);
+            EXPECT_TRUE(head.complete());
+            EXPECT_FALSE(head.keep_alive());
+
+            http_response_parser nc;
+            nc.parse("HTTP/1.1 204 No Content\r\n\r\n", h);
+            EXPECT_TRUE(nc.complete());
+        }
+
+        // Malformed
+        for (std::string_view bad : {"HTTP/1.1 2000 OK\r\n\r\n",
+                                     "SMTP 200 OK\r\n\r\n",
+                                     "HTTP/1.1 200 OK\r\nContent-Length: -1\r\n\r\n",
+                                     "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n",
+                                     "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n1\r\nab\r\n"})
+        {
+            http_response_parser parser;
+            recording_handler    h;
+            parser.parse(bad, h);
+            EXPECT_TRUE(parser.failed());
+        }
+
+        // A line without end is bounded
+        http_response_parser parser;
+        recording_handler    h;
+        std::string          endless = "HTTP/1.1 200 OK\r\nX: " + std::string(http_response_parser::MAX_LINE, 'a');
+        EXPECT_EQ(17, parser.parse(endless, h));
+        EXPECT_TRUE(parser.failed());
+    }
+
+
+    TEST(HttpParser, find_byte)
+    {
+        std::string s(100, 'a');
+        for (size_t i = 0; i < s.length(); i++) {
+            s[i] = '\n';
+            EXPECT_EQ(i, find_byte(s, '\n'));
+            EXPECT_EQ(i, find_byte(std::string_view(s).substr(0, i + 1), '\n'));
+            s[i] = 'a';
+        }
+        EXPECT_EQ(std::string_view::npos, find_byte(s, '\n'));
+        EXPECT_EQ(std::string_view::npos, find_byte({}, '\n'));
+    }
+
+
+    /// @brief Throughput of the response parser; run explicitly with --gtest_also_run_disabled_tests
+    TEST(Benchmark, DISABLED_ResponseParse)
+    {
+        std::string head = "HTTP/1.1 200 OK\r\nDate: Fri, 16 Oct 2026 07:19:07 GMT\r\nContent-Type: application/json; charset=utf-8\r\n"
+                           "Cache-Control: no-cache, no-store, must-revalidate\r\nX-Request-Id: 5b3c6e0a-8d1f-4c2b-9a7e-3f6d2c1b0a98\r\n"
+                           "Strict-Transport-Security: max-age=31536000; includeSubDomains\r\nVary: Accept-Encoding, Origin\r\n"
+                           "ETag: W/\"2f-6a9cf0f1b1f2\"\r\nServer: nginx\r\nX-RateLimit-Remaining: 4999\r\n";
+        std::string small = head + "Content-Length: 47\r\n\r\n" + R"({"id":"5b3c6e0a","status":"ok","count":1234567})";
+        std::string chunked = head + "Transfer-Encoding: chunked\r\n\r\n";
+        for (int i = 0; i < 64; i++) chunked += std::format("400\r\n{}\r\n", std::string(1024, 'x'));
+        chunked += "0\r\n\r\n";
+
+        struct counting_handler
+        {
+            size_t n {0};
+            void   on_status(std::string_view, uint32_t s, std::string_view) { n += s; }
+            void   on_header(std::string_view k, std::string_view v) { n += k.length() + v.length(); }
+            void   on_headers_complete() { }
+            void   on_body(std::string_view b) { n += b.length(); }
+        };
+
+        for (auto& [name, wire] : {std::pair {"head+small body", &small}, std::pair {"64 KB chunked", &chunked}}) {
+            for (size_t piece : {wire->length(), size_t(1460)}) {
+                size_t rounds = std::max<size_t>(1, (256u << 20) / wire->length());
+                counting_handler h;
+                std::string      pending {};
+                auto             start = std::chrono::steady_clock::now();
+                for (size_t r = 0; r < rounds; r++) {
+                    http_response_parser parser;
+                    for (size_t i = 0; i < wire->length(); i += piece) {
+                        pending.append(std::string_view(*wire).substr(i, piece));
+                        pending.erase(0, parser.parse(pending, h));
+                    }
+                    EXPECT_TRUE(parser.complete());
+                }
+                auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cerr << std::format("ResponseParse {} in {} byte pieces: {:.1f} MB/s, {:.0f} ns/response\n",
+                                         name,
+                                         piece,
+                                         double(wire->length() * rounds) / secs / (1 << 20),
+                                         secs * 1e9 / double(rounds));
+                EXPECT_GT(h.n, 0);
+            }
+        }
+
+        // The delimiter scan against a byte loop on a 4 KB line
+        std::string line(4096, 'a');
+        line.back() = '\n';
+        auto scan   = [&](auto&& find) {
+            size_t sink  = 0;
+            auto   start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 100000; i++) sink += find(std::string_view(line));
+            EXPECT_GT(sink, 0);
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        };
+        auto simd  = scan([](std::string_view s) { return find_byte(s, '\n'); });
+        auto bytes = scan([](std::string_view s) {
+            size_t i = 0;
+            while (i < s.length() && s[i] != '\n') i++;
+            return i;
+        });
+        std::cerr << std::format("find_byte: {:.2f} GB/s, byte loop: {:.2f} GB/s\n",
+                                 4096.0 * 100000 / simd / 1e9,
+                                 4096.0 * 100000 / bytes / 1e9);
+    }
+
+
     TEST(Validate, test1)
     {
         auto r1 = "https://www.siddiqsoft.com:65535/"_GET;
@@ -98,8 +1072,580 @@ namespace siddiqsoft
         EXPECT_EQ("OPTIONS", r3["request"].value("method", ""));
         EXPECT_EQ(9090, r3.uri.authority.port);
     }
+
+
+    TEST(ConnectionPool, CheckoutCheckin)
+    {
+        std::vector<int>     evicted;
+        connection_pool<int> pool({.maxIdlePerOrigin = 2, .maxPerOrigin = 3}, [&](int& c) { evicted.push_back(c); });
+
+        EXPECT_EQ(2, pool.limits().maxIdlePerOrigin);
+        EXPECT_EQ(3, pool.limits().maxPerOrigin);
+
+        auto* b = pool.origin(connection_pool<int>::key(UriScheme::WebHttps, "example.com", 443));
+        ASSERT_TRUE(b != nullptr);
+        EXPECT_EQ(b, pool.origin("https://example.com:443"));
+        EXPECT_FALSE(pool.checkout(*b).has_value());
+
+        // Limited to three open connections
+        EXPECT_TRUE(pool.try_reserve(*b));
+        EXPECT_TRUE(pool.try_reserve(*b));
+        EXPECT_TRUE(pool.try_reserve(*b));
+        EXPECT_FALSE(pool.try_reserve(*b));
+
+        // Only two may idle; the third is evicted
+        EXPECT_TRUE(pool.checkin(*b, 1));
+        EXPECT_TRUE(pool.checkin(*b, 2));
+        EXPECT_FALSE(pool.checkin(*b, 3));
+        EXPECT_EQ(std::vector<int>({3}), evicted);
+        EXPECT_EQ(2, b->openCount());
+        EXPECT_EQ(2, b->idleCount());
+
+        auto c = pool.checkout(*b);
+        ASSERT_TRUE(c.has_value());
+        EXPECT_EQ(1, b->idleCount());
+        EXPECT_TRUE(pool.remove(*b, *c == 1 ? 2 : 1));
+        EXPECT_EQ(0, b->idleCount());
+        EXPECT_EQ(1, b->openCount());
+    }
+
+
+    TEST(ConnectionPool, IdleEviction)
+    {
+        std::atomic_uint     evicted {0};
+        connection_pool<int> pool({.maxIdleTime = std::chrono::milliseconds(0)}, [&](int&) { evicted++; });
+
+        auto* b = pool.origin("http://localhost:80");
+        ASSERT_TRUE(pool.try_reserve(*b));
+        pool.checkin(*b, 7);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        // Stale connections are never handed out
+        EXPECT_FALSE(pool.checkout(*b).has_value());
+        EXPECT_EQ(1, evicted.load());
+        EXPECT_EQ(0, b->openCount());
+
+        ASSERT_TRUE(pool.try_reserve(*b));
+        pool.checkin(*b, 8);
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        EXPECT_EQ(1, pool.evict_idle());
+        EXPECT_EQ(2, evicted.load());
+    }
+
+
+    TEST(ConnectionPool, Concurrent)
+    {
+        const int            THREADS = 8, ITER_COUNT = 10000;
+        std::atomic_int      created {0};
+        connection_pool<int> pool({.maxIdlePerOrigin = 4, .maxPerOrigin = 4});
+        auto*                b = pool.origin("http://localhost:80");
+
+        std::vector<std::jthread> threads;
+        for (auto t = 0; t < THREADS; t++) {
+            threads.emplace_back([&] {
+                for (auto i = 0; i < ITER_COUNT; i++) {
+                    auto lease = pool.acquire(*b, [&]() -> std::optional<int> { return ++created; });
+                    if (lease) EXPECT_NE(0, lease.get());
+                }
+            });
+        }
+        threads.clear();
+
+        // Never more than the per-origin limit
+        EXPECT_LE(created.load(), 4);
+        EXPECT_EQ(b->idleCount(), b->openCount());
+    }
+
+
+    struct test_timer : timer_wheel::timer
+    {
+        int64_t expiry {0}; // milliseconds since the start
+    };
+
+
+    TEST(TimerWheel, ScheduleAndFire)
+    {
+        const int64_t           COUNT = 20000;
+        auto                    start = timer_wheel::clock_type::now();
+        auto                    at    = [&](int64_t ms) { return start + std::chrono::milliseconds(ms); };
+        timer_wheel             wheel {start};
+        std::vector<test_timer> timers(COUNT);
+
+        // Spread across every level and beyond the range of the wheel
+        uint64_t seed = 88172645463325252ull;
+        for (auto& t : timers) {
+            seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+            auto range = std::array<int64_t, 5> {60, 4000, 250000, 16000000, 40000000}[seed % 5];
+            t.expiry   = 1 + static_cast<int64_t>((seed >> 8) % range);
+            wheel.schedule(t, at(t.expiry));
+        }
+        EXPECT_EQ(COUNT, wheel.size());
+
+        // Every third is cancelled and every seventh re-armed
+        for (int64_t i = 0; i < COUNT; i += 3) wheel.cancel(timers[i]);
+        for (int64_t i = 0; i < COUNT; i += 7) {
+            timers[i].expiry = 1 + (i * 37) % 100000;
+            wheel.schedule(timers[i], at(timers[i].expiry));
+        }
+        size_t armed = 0;
+        for (auto& t : timers) armed += t.armed();
+        EXPECT_EQ(armed, wheel.size());
+
+        // Advance in uneven steps; each timer fires within the step in which it is due
+        int64_t now    = 0;
+        size_t  fired  = 0;
+        int64_t offset = 0;
+        while (!wheel.empty()) {
+            auto next = wheel.next_timeout(at(now));
+            ASSERT_TRUE(next.has_value());
+            offset = now;
+            now += std::max<int64_t>(next->count(), 1) + (now % 13);
+            wheel.advance(at(now), [&](timer_wheel::timer& t) {
+                auto& tt = static_cast<test_timer&>(t);
+                EXPECT_FALSE(tt.armed());
+                // Not early and not left behind
+                EXPECT_GT(tt.expiry, offset);
+                EXPECT_LE(tt.expiry, now);
+                fired++;
+            });
+        }
+        EXPECT_EQ(armed, fired);
+    }
+
+
+    TEST(TimerWheel, Rearm_From_Callback)
+    {
+        auto        start = timer_wheel::clock_type::now();
+        timer_wheel wheel {start};
+        test_timer  a, b;
+
+        wheel.schedule(a, start + std::chrono::milliseconds(5));
+        wheel.schedule(b, start + std::chrono::milliseconds(5));
+        EXPECT_EQ(std::chrono::milliseconds(5), wheel.next_timeout(start));
+
+        // The first to fire cancels the other and re-arms itself
+        int calls = 0;
+        wheel.advance(start + std::chrono::milliseconds(5), [&](timer_wheel::timer& t) {
+            calls++;
+            wheel.cancel(&t == &a ? b : a);
+            wheel.schedule(t, start + std::chrono::milliseconds(100));
+        });
+        EXPECT_EQ(1, calls);
+        EXPECT_EQ(1, wheel.size());
+
+        // A time in the past fires on the next advance
+        wheel.schedule(a, start);
+        wheel.schedule(b, start);
+        wheel.advance(start + std::chrono::milliseconds(6), [&](timer_wheel::timer&) { calls++; });
+        EXPECT_EQ(3, calls);
+        EXPECT_TRUE(wheel.empty());
+        EXPECT_FALSE(wheel.next_timeout(start).has_value());
+    }
+
+
+    /// @brief Stand-in backend: the synchronous send() waits for the latency and echoes the path; the asynchronous send()
+    /// runs on an async_executor as a backend without native asynchronous IO would. The path /gate waits for the gate.
+    class mock_restclient : public basic_restclient
+    {
+    public:
+        std::chrono::microseconds  latency {0};
+        std::atomic_uint           sent {0};
+        std::counting_semaphore<8> gate {0};
+
+        explicit mock_restclient(unsigned threads = 0, std::chrono::microseconds latency = {})
+            : latency(latency)
+            , executor(*this, threads)
+        {
+        }
+
+        explicit mock_restclient(const executor_options& opts, std::chrono::microseconds latency = {})
+            : latency(latency)
+            , executor(*this, opts)
+        {
+        }
+
+        using basic_restclient::send;
+
+        [[nodiscard]] basic_response send(basic_request& req) override
+        {
+            if (req.uri.urlPart == "/throw") throw std::runtime_error("mock failure");
+            if (req.uri.urlPart == "/gate") gate.acquire();
+            if (latency.count() > 0) std::this_thread::sleep_for(latency);
+            sent++;
+            rest_response resp {200, "OK"};
+            resp.headers().set("Content-Type", "text/plain");
+            resp.setContent(req.uri.urlPart);
+            return resp;
+        }
+
+        void send(basic_request&& req, basic_callbacktype& callback) override
+        {
+            executor.submit(std::move(req), [callback](basic_request&& q, basic_response&& r) { callback(q, r); });
+        }
+
+        void send(basic_request&& req, basic_callbacktype&& callback) override
+        {
+            executor.submit(std::move(req), [callback = std::move(callback)](basic_request&& q, basic_response&& r) { callback(q, r); });
+        }
+
+        const async_executor& getExecutor() const { return executor; }
+
+    protected:
+        void dispatch(basic_request&& req, basic_movecallbacktype&& callback) override
+        {
+            executor.submit(std::move(req), std::move(callback));
+        }
+
+    private:
+        async_executor executor;
+    };
+
+
+    TEST(Executor, send_async)
+    {
+        const unsigned   ITER_COUNT = 500;
+        std::atomic_uint passTest {0};
+        std::atomic_uint completed {0};
+        mock_restclient  mrc {4};
+        EXPECT_EQ(4, mrc.getExecutor().concurrency());
+
+        basic_callbacktype valid = [&](const auto& req, const auto& resp) {
+            if (resp.success() && resp.rawContent() == req.uri.urlPart) passTest++;
+            completed++;
+            completed.notify_all();
+        };
+
+        // Submitted from several threads
+        {
+            std::vector<std::jthread> submitters;
+            for (unsigned t = 0; t < 4; t++) {
+                submitters.emplace_back([&, t] {
+                    for (unsigned i = t; i < ITER_COUNT; i += 4) {
+                        mrc.send(ReqGet {SplitUri(std::format("http://localhost/item/{}", i))}, valid);
+                    }
+                });
+            }
+        }
+
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, passTest.load());
+        EXPECT_EQ(ITER_COUNT, mrc.sent.load());
+
+        // An exception in the backend completes the request
+        std::binary_semaphore done {0};
+        int                   status {0};
+        mrc.send(ReqGet {SplitUri(std::string("http://localhost/throw"))}, [&](basic_response&& resp) {
+            status = resp.status().code;
+            done.release();
+        });
+        ASSERT_TRUE(done.try_acquire_for(std::chrono::seconds(5)));
+        EXPECT_EQ(static_cast<int>(restcl_status::Exception), status);
+    }
+
+
+    TEST(Executor, work_stealing)
+    {
+        const unsigned   ITER_COUNT = 64;
+        std::atomic_uint completed {0};
+        mock_restclient  mrc {4, std::chrono::milliseconds(2)};
+
+        // Requests submitted from within a callback are queued on that worker; the idle workers steal them
+        std::binary_semaphore seeded {0};
+        mrc.send(ReqGet {SplitUri(std::string("http://localhost/seed"))}, [&](basic_response&&) {
+            for (unsigned i = 0; i < ITER_COUNT; i++) {
+                mrc.send(ReqGet {SplitUri(std::format("http://localhost/stolen/{}", i))}, [&](basic_response&&) {
+                    completed++;
+                    completed.notify_all();
+                });
+            }
+            seeded.release();
+        });
+        ASSERT_TRUE(seeded.try_acquire_for(std::chrono::seconds(5)));
+
+        auto start = std::chrono::steady_clock::now();
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_GT(mrc.getExecutor().stats().steals, 0);
+        // One worker alone would take 64 x 2ms
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(ITER_COUNT * 2));
+    }
+
+
+    TEST(Executor, shutdown)
+    {
+        std::atomic_uint sent {0}, cancelled {0};
+        {
+            mock_restclient mrc {1, std::chrono::milliseconds(20)};
+            for (int i = 0; i < 10; i++) {
+                mrc.send(ReqGet {SplitUri(std::format("http://localhost/{}", i))}, [&](basic_response&& resp) {
+                    if (resp.status().code == static_cast<int>(restcl_status::Shutdown)) cancelled++;
+                    else if (resp.success())
+                        sent++;
+                });
+            }
+        }
+        // Every callback is invoked once: the request in progress completes and the queued requests are cancelled
+        EXPECT_EQ(10, sent.load() + cancelled.load());
+        EXPECT_GT(cancelled.load(), 0);
+    }
+
+
+    TEST(Executor, backpressure)
+    {
+        auto path = [](std::string_view p) { return ReqGet {SplitUri(std::format("http://localhost{}", p))}; };
+
+        for (auto policy : {overflow_policy::Reject, overflow_policy::DropOldest, overflow_policy::Block}) {
+            mock_restclient mrc {executor_options {.threads = 1, .capacity = 2, .overflow = policy}};
+
+            std::mutex                          lock;
+            std::map<std::string, unsigned>     results;
+            std::atomic_uint                    completed {0};
+            auto                                record = [&](basic_request&& req, basic_response&& resp) {
+                {
+                    std::scoped_lock<std::mutex> l(lock);
+                    results[req.uri.urlPart] = resp.status().code;
+                }
+                completed++;
+                completed.notify_all();
+            };
+
+            // The worker is held by the gate while two requests fill the queue
+            mrc.send(path("/gate"), record);
+            while (mrc.getExecutor().stats().started == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            mrc.send(path("/1"), record);
+            mrc.send(path("/2"), record);
+            EXPECT_EQ(2, mrc.getExecutor().stats().depth);
+
+            std::atomic_bool submitted {false};
+            std::jthread     overflow([&] {
+                mrc.send(path("/3"), record);
+                submitted = true;
+            });
+
+            if (policy == overflow_policy::Block) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                EXPECT_FALSE(submitted.load());
+            }
+            else {
+                while (!submitted) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            mrc.gate.release();
+            overflow.join();
+            for (auto c = completed.load(); c < 4; c = completed.load()) completed.wait(c);
+
+            auto stats = mrc.getExecutor().stats();
+            EXPECT_EQ(200, results["/gate"]);
+            EXPECT_EQ(2, stats.peakDepth);
+            EXPECT_EQ(4, stats.submitted);
+            EXPECT_EQ(0, stats.depth);
+            if (policy == overflow_policy::Reject) {
+                EXPECT_EQ(static_cast<unsigned>(restcl_status::QueueFull), results["/3"]);
+                EXPECT_EQ(200, results["/1"]);
+                EXPECT_EQ(1, stats.rejected);
+                EXPECT_EQ(3, stats.started);
+            }
+            else if (policy == overflow_policy::DropOldest) {
+                EXPECT_EQ(static_cast<unsigned>(restcl_status::Dropped), results["/1"]);
+                EXPECT_EQ(200, results["/3"]);
+                EXPECT_EQ(1, stats.dropped);
+                EXPECT_EQ(3, stats.started);
+            }
+            else {
+                EXPECT_EQ(200, results["/1"]);
+                EXPECT_EQ(200, results["/3"]);
+                EXPECT_EQ(4, stats.started);
+                // The queued requests waited for the gate
+                EXPECT_GE(stats.maxWait, std::chrono::milliseconds(50));
+                EXPECT_GT(stats.averageWait().count(), 0);
+            }
+        }
+    }
+
+
+    TEST(Executor, priority_lanes)
+    {
+        const unsigned  ITER_COUNT = 6;
+        mock_restclient mrc {executor_options {.threads = 1, .laneWeights = {2, 1, 1}}};
+
+        std::mutex                    lock;
+        std::vector<request_priority> order;
+        std::atomic_uint              completed {0};
+        auto                          record = [&](basic_request&& req, basic_response&&) {
+            {
+                std::scoped_lock<std::mutex> l(lock);
+                order.push_back(req.getPriority());
+            }
+            completed++;
+            completed.notify_all();
+        };
+
+        // The worker is held by the gate while the bulk requests queue ahead of the urgent ones
+        mrc.send(ReqGet {SplitUri(std::string("http://localhost/gate"))}, record);
+        while (mrc.getExecutor().stats().started == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        for (auto p : {request_priority::Low, request_priority::High}) {
+            for (unsigned i = 0; i < ITER_COUNT; i++) {
+                ReqGet req {SplitUri(std::format("http://localhost/{}", i))};
+                req.setPriority(p);
+                mrc.send(std::move(req), record);
+            }
+        }
+        EXPECT_EQ(ITER_COUNT, mrc.getExecutor().stats().lane(request_priority::Low).depth);
+        EXPECT_EQ(ITER_COUNT, mrc.getExecutor().stats().lane(request_priority::High).depth);
+        mrc.gate.release();
+        for (auto c = completed.load(); c < 1 + 2 * ITER_COUNT; c = completed.load()) completed.wait(c);
+
+        // Two High for every Low: the High requests overtake the Low requests and the Low requests are not starved
+        std::vector<request_priority> expected {request_priority::Normal};
+        for (auto c : std::string_view {"HHLHHLHHLLLL"}) expected.push_back(c == 'H' ? request_priority::High : request_priority::Low);
+        EXPECT_EQ(expected, order);
+
+        auto stats = mrc.getExecutor().stats();
+        EXPECT_EQ(1 + 2 * ITER_COUNT, stats.started);
+        EXPECT_EQ(1, stats.lane(request_priority::Normal).completed);
+        EXPECT_EQ(ITER_COUNT, stats.lane(request_priority::High).completed);
+        EXPECT_EQ(ITER_COUNT, stats.lane(request_priority::Low).completed);
+        EXPECT_EQ(0, stats.lane(request_priority::Low).depth);
+        EXPECT_LT(stats.lane(request_priority::High).averageWait(), stats.lane(request_priority::Low).averageWait());
+        EXPECT_GE(stats.lane(request_priority::Low).maxLatency, stats.lane(request_priority::Low).maxWait);
+        EXPECT_GT(stats.lane(request_priority::High).averageLatency().count(), 0);
+    }
+
+
+    TEST(Executor, deadlines)
+    {
+        mock_restclient mrc {1};
+
+        std::mutex                 lock;
+        std::vector<std::string>   order;
+        std::map<std::string, int> results;
+        std::atomic_uint           completed {0};
+        auto                       record = [&](basic_request&& req, basic_response&& resp) {
+            {
+                std::scoped_lock<std::mutex> l(lock);
+                order.push_back(req.uri.urlPart);
+                results[req.uri.urlPart] = resp.status().code;
+            }
+            completed++;
+            completed.notify_all();
+        };
+        auto send = [&](std::string_view path, std::optional<std::chrono::milliseconds> budget) {
+            ReqGet req {SplitUri(std::format("http://localhost{}", path))};
+            if (budget) req.setTimeout(*budget);
+            mrc.send(std::move(req), record);
+        };
+
+        // While the gate holds the worker the queue is ordered earliest deadline first
+        send("/gate", std::nullopt);
+        while (mrc.getExecutor().stats().started == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        send("/none", std::nullopt);
+        send("/5s", std::chrono::seconds(5));
+        send("/3s", std::chrono::seconds(3));
+        send("/4s", std::chrono::seconds(4));
+        send("/expires", std::chrono::milliseconds(20));
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        mrc.gate.release();
+        for (auto c = completed.load(); c < 6; c = completed.load()) completed.wait(c);
+
+        EXPECT_EQ((std::vector<std::string> {"/gate", "/expires", "/3s", "/4s", "/5s", "/none"}), order);
+        // The expired request was not sent
+        EXPECT_EQ(static_cast<int>(restcl_status::Timeout), results["/expires"]);
+        EXPECT_EQ(200, results["/3s"]);
+        EXPECT_EQ(5, mrc.sent.load());
+        EXPECT_EQ(1, mrc.getExecutor().stats().expired);
+
+        ReqGet req {SplitUri(std::string("http://localhost/"))};
+        EXPECT_FALSE(req.hasDeadline());
+        EXPECT_FALSE(req.expired());
+        EXPECT_EQ(std::chrono::milliseconds::max(), req.remaining());
+        req.setTimeout(std::chrono::seconds(2));
+        EXPECT_TRUE(req.hasDeadline());
+        EXPECT_GT(req.remaining(), std::chrono::milliseconds(1900));
+        EXPECT_LE(req.remaining(), std::chrono::milliseconds(2000));
+        EXPECT_TRUE(req.expired(req.getDeadline()));
+        EXPECT_EQ(std::chrono::milliseconds(0), req.remaining(req.getDeadline() + std::chrono::seconds(1)));
+    }
+
+
+    TEST(Executor, cancel)
+    {
+        mock_restclient mrc {1};
+
+        std::mutex                 lock;
+        std::map<std::string, int> results;
+        std::atomic_uint           completed {0};
+        auto                       record = [&](basic_request&& req, basic_response&& resp) {
+            {
+                std::scoped_lock<std::mutex> l(lock);
+                results[req.uri.urlPart] = resp.status().code;
+            }
+            completed++;
+            completed.notify_all();
+        };
+        auto path = [](std::string_view p) { return ReqGet {SplitUri(std::format("http://localhost{}", p))}; };
+
+        mrc.send(path("/gate"), record);
+        while (mrc.getExecutor().stats().started == 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // Queued behind the gate; the stop removes it from the queue and completes it on this thread
+        std::stop_source cancel;
+        mrc.send(path("/cancelled"), cancel.get_token(), record);
+        mrc.send(path("/kept"), std::stop_token {}, record);
+        EXPECT_EQ(2, mrc.getExecutor().stats().depth);
+        cancel.request_stop();
+        EXPECT_EQ(1, completed.load());
+        EXPECT_EQ(1, mrc.getExecutor().stats().depth);
+
+        // Stopped before the send
+        mrc.send(path("/early"), cancel.get_token(), [&](const basic_request& req, const basic_response& resp) {
+            record(basic_request {req}, basic_response {resp});
+        });
+        EXPECT_EQ(2, completed.load());
+
+        mrc.gate.release();
+        for (auto c = completed.load(); c < 4; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), results["/cancelled"]);
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), results["/early"]);
+        EXPECT_EQ(200, results["/kept"]);
+        EXPECT_EQ(2, mrc.sent.load());
+        EXPECT_EQ(2, mrc.getExecutor().stats().cancelled);
+        EXPECT_EQ(0, mrc.getExecutor().stats().depth);
+    }
+
+
+    TEST(Benchmark, DISABLED_ExecutorScaling)
+    {
+        // Throughput of the executor over a backend whose send() waits (io) or computes (cpu) for 100us
+        const unsigned ITER_COUNT = 20000;
+        auto           spin       = [](basic_request&) {
+            auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(100);
+            while (std::chrono::steady_clock::now() < until) { }
+        };
+
+        for (bool io : {true, false}) {
+            for (unsigned threads : {1u, 2u, 4u, 8u, 16u, 32u}) {
+                if (!io && threads > std::thread::hardware_concurrency()) continue;
+                mock_restclient  mrc {threads, io ? std::chrono::microseconds(100) : std::chrono::microseconds(0)};
+                std::atomic_uint completed {0};
+                auto             start = std::chrono::steady_clock::now();
+                for (unsigned i = 0; i < ITER_COUNT; i++) {
+                    mrc.send(ReqGet {SplitUri(std::string("http://localhost/bench"))}, [&](basic_request&& req, basic_response&&) {
+                        if (!io) spin(req);
+                        completed++;
+                        completed.notify_all();
+                    });
+                }
+                for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+                auto secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cerr << std::format("ExecutorScaling {} {:>2} threads: {:>8.0f} req/s, {} steals\n",
+                                         io ? "io " : "cpu",
+                                         threads,
+                                         ITER_COUNT / secs,
+                                         mrc.getExecutor().stats().steals);
+            }
+        }
+    }
 } // namespace siddiqsoft
 
+#if defined(_WIN32)
 namespace siddiqsoft
 {
     using namespace restcl_literals;
@@ -380,6 +1926,17 @@ namespace siddiqsoft
     }
 
 
+    TEST(restcl, MoveConstructor_Options)
+    {
+        siddiqsoft::WinHttpRESTClient src {"restcl-test", {.threads = 2, .capacity = 8, .overflow = siddiqsoft::overflow_policy::Reject}};
+        siddiqsoft::WinHttpRESTClient wrc {std::move(src)};
+
+        EXPECT_EQ(2, wrc.asyncOptions().threads);
+        EXPECT_EQ(8, wrc.asyncOptions().capacity);
+        EXPECT_EQ(siddiqsoft::overflow_policy::Reject, wrc.asyncOptions().overflow);
+    }
+
+
     TEST(Threads, test_1)
     {
         const unsigned   ITER_COUNT = 9;
@@ -476,3 +2033,4 @@ namespace siddiqsoft
         EXPECT_EQ(ITER_COUNT, passTest.load());
     }
 } // namespace siddiqsoft
+#endif
@@ -0,0 +1,915 @@
+/*
+    restcl : Tests for the Linux (epoll) client
+
+    BSD 3-Clause License
+
+    Copyright (c) 2021, Siddiq Software LLC
+    All rights reserved.
+
+    Redistribution and use in source and binary forms, with or without
+    modification, are permitted provided that the following conditions are met:
+
+    1. Redistributions of source code must retain the above copyright notice, this
+    list of conditions and the following disclaimer.
+
+    2. Redistributions in binary form must reproduce the above copyright notice,
+    this list of conditions and the following disclaimer in the documentation
+    and/or other materials provided with the distribution.
+
+    3. Neither the name of the copyright holder nor the names of its
+    contributors may be used to endorse or promote products derived from
+    this software without specific prior written permission.
+
+    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+    AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+    IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+    DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+    FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+    DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+    SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+    OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+    OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "gtest/gtest.h"
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <map>
+#include <new>
+#include <cstdlib>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <arpa/inet.h>
+
+#include "nlohmann/json.hpp"
+#include "../include/siddiqsoft/restcl.hpp"
+#include "../include/siddiqsoft/restcl_epoll.hpp"
+
+
+/// @brief Allocations made by any thread other than the loopback server's while counting is enabled
+/// (see Send_Async_NoAllocation). Every form of the global operators is replaced so that new and delete stay paired.
+static std::atomic_bool   countAllocations {false};
+static std::atomic_size_t allocationCount {0};
+static thread_local bool  uncountedThread {false};
+
+[[gnu::noinline]] static void* countedAlloc(std::size_t size, std::size_t alignment = 0) noexcept
+{
+    if (countAllocations.load(std::memory_order_relaxed) && !uncountedThread) allocationCount++;
+    if (size == 0) size = 1;
+    if (alignment == 0) return std::malloc(size);
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+[[gnu::noinline]] static void countedFree(void* p) noexcept { std::free(p); }
+
+static void* countedNew(std::size_t size, std::size_t alignment = 0)
+{
+    if (auto* p = countedAlloc(size, alignment); p != nullptr) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return countedNew(size); }
+void* operator new[](std::size_t size) { return countedNew(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return countedNew(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return countedNew(size, static_cast<std::size_t>(al)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAlloc(size); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return countedAlloc(size, static_cast<std::size_t>(al));
+}
+
+void operator delete(void* p) noexcept { countedFree(p); }
+void operator delete[](void* p) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedFree(p); }
+
+
+namespace siddiqsoft
+{
+    /// @brief Single threaded HTTP/1.1 stand-in server bound to the loopback interface on an ephemeral port.
+    /// Routes:
+    ///   /chunked  responds with a chunked body
+    ///   /close    responds and closes the connection
+    ///   /drop     closes the connection without a response
+    ///   /held     echoes once releaseHeld() is called
+    ///   /stall*   never responds
+    ///   /trickle  sends the head and part of the body, then stalls
+    ///   anything else echoes the method, path and body as json
+    class loopback_server
+    {
+        struct client
+        {
+            std::string buffer {};
+        };
+
+        int                     listener {-1};
+        std::map<int, client>   clients {};
+        std::jthread            worker {};
+
+    public:
+        uint16_t              port {0};
+        std::atomic_uint      accepted {0};
+        std::atomic_uint      served {0};
+        std::atomic_uint      held {0}; // received /held requests not yet answered
+
+        loopback_server()
+        {
+            listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int one  = 1;
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+            sockaddr_in addr {};
+            addr.sin_family      = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port        = 0;
+            ::bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            ::listen(listener, 4096);
+
+            socklen_t len = sizeof(addr);
+            getsockname(listener, reinterpret_cast<sockaddr*>(&addr), &len);
+            port = ntohs(addr.sin_port);
+
+            worker = std::jthread([this](std::stop_token st) { run(st); });
+        }
+
+        ~loopback_server()
+        {
+            worker.request_stop();
+            if (worker.joinable()) worker.join();
+            for (auto& [fd, _] : clients) ::close(fd);
+            ::close(listener);
+        }
+
+        std::string url(std::string_view path) const { return std::format("http://127.0.0.1:{}{}", port, path); }
+
+        /// @brief Answer the held requests; returns once the responses are written
+        void releaseHeld()
+        {
+            heldRelease = true;
+            while (held.load() > 0) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+    private:
+        std::vector<std::pair<int, std::string>> heldResponses {};
+        std::atomic_bool                         heldRelease {false};
+
+        void run(std::stop_token st)
+        {
+            // The server is not part of the client under test
+            uncountedThread = true;
+            while (!st.stop_requested()) {
+                if (heldRelease.exchange(false)) {
+                    for (auto& [fd, out] : heldResponses) ::send(fd, out.data(), out.length(), MSG_NOSIGNAL);
+                    served += static_cast<unsigned>(heldResponses.size());
+                    heldResponses.clear();
+                    held = 0;
+                }
+
+                std::vector<pollfd> fds {{.fd = listener, .events = POLLIN, .revents = 0}};
+                for (auto& [fd, _] : clients) fds.push_back({.fd = fd, .events = POLLIN, .revents = 0});
+
+                if (::poll(fds.data(), fds.size(), 20) <= 0) continue;
+
+                if (fds[0].revents & POLLIN) {
+                    if (int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC); fd >= 0) {
+                        clients[fd] = {};
+                        accepted++;
+                    }
+                }
+
+                for (size_t i = 1; i < fds.size(); i++) {
+                    if (fds[i].revents == 0) continue;
+                    char buf[8192];
+                    auto rc = ::recv(fds[i].fd, buf, sizeof(buf), 0);
+                    if (rc <= 0) {
+                        ::close(fds[i].fd);
+                        clients.erase(fds[i].fd);
+                        continue;
+                    }
+                    clients[fds[i].fd].buffer.append(buf, rc);
+                    if (!serve(fds[i].fd, clients[fds[i].fd].buffer)) {
+                        ::close(fds[i].fd);
+                        clients.erase(fds[i].fd);
+                    }
+                }
+            }
+        }
+
+        /// @brief Respond to every complete request in the buffer
+        /// @return false if the connection must be closed
+        bool serve(int fd, std::string& buffer)
+        {
+            while (true) {
+                auto end = buffer.find("\r\n\r\n");
+                if (end == std::string::npos) return true;
+
+                std::string_view head {buffer.data(), end};
+                size_t           contentLength {0};
+                if (auto cl = head.find("Content-Length: "); cl != std::string_view::npos) {
+                    contentLength = std::stoul(std::string {head.substr(cl + 16, head.find("\r\n", cl) - cl - 16)});
+                }
+                if (buffer.length() < end + 4 + contentLength) return true;
+
+                auto method = std::string {head.substr(0, head.find(' '))};
+                auto path   = std::string {head.substr(method.length() + 1, head.find(' ', method.length() + 1) - method.length() - 1)};
+                auto body   = buffer.substr(end + 4, contentLength);
+                buffer.erase(0, end + 4 + contentLength);
+
+                std::string out {};
+                bool        keepOpen = true;
+                auto        doc      = nlohmann::json {{"method", method}, {"path", path}, {"body", body}}.dump();
+
+                if (path.starts_with("/stall")) {
+                    continue;
+                }
+                else if (path == "/held") {
+                    heldResponses.emplace_back(
+                            fd,
+                            std::format("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: {}\r\n\r\n{}", doc.length(), doc));
+                    held++;
+                    continue;
+                }
+                else if (path == "/drop") {
+                    served++;
+                    return false;
+                }
+                else if (path == "/trickle") {
+                    out = std::format("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: {}\r\n\r\n{}",
+                                      doc.length() + 1,
+                                      doc);
+                }
+                else if (path == "/chunked") {
+                    auto half = doc.length() / 2;
+                    out       = std::format("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                                  "{:x}\r\n{}\r\n{:x}\r\n{}\r\n0\r\n\r\n",
+                                          half,
+                                          doc.substr(0, half),
+                                          doc.length() - half,
+                                          doc.substr(half));
+                }
+                else if (path == "/close") {
+                    out      = std::format("HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nConnection: close\r\n\r\n{}", doc);
+                    keepOpen = false;
+                }
+                else {
+                    out = std::format(
+                            "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: {}\r\n\r\n{}",
+                            doc.length(),
+                            method == "HEAD" ? "" : doc);
+                }
+
+                served++;
+                ::send(fd, out.data(), out.length(), MSG_NOSIGNAL);
+                if (!keepOpen) return false;
+            }
+        }
+    };
+
+
+    TEST(EpollRESTClient, Send_Synchronous)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto req  = ReqGet {SplitUri(server.url("/hello"))};
+        auto resp = erc.send(req);
+
+        ASSERT_TRUE(resp.success());
+        EXPECT_EQ(200, resp.status().code);
+        EXPECT_EQ("GET", resp["content"].value("method", ""));
+        EXPECT_EQ("/hello", resp["content"].value("path", ""));
+        EXPECT_EQ(erc.UserAgent, req["headers"].value("User-Agent", ""));
+    }
+
+
+    TEST(EpollRESTClient, Omit_Date)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+        erc.SendDate = false;
+
+        auto req  = ReqGet {SplitUri(server.url("/nodate"))};
+        EXPECT_TRUE(req.headers().contains("Date"));
+        auto resp = erc.send(req);
+        ASSERT_TRUE(resp.success());
+        EXPECT_FALSE(req.headers().contains("Date"));
+    }
+
+
+    TEST(EpollRESTClient, Send_Post)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto req  = ReqPost {SplitUri(server.url("/post")), {{"X-Test", "1"}}, {{"foo", "bar"}}};
+        auto resp = erc.send(req);
+
+        ASSERT_TRUE(resp.success());
+        EXPECT_EQ("POST", resp["content"].value("method", ""));
+        EXPECT_EQ(nlohmann::json({{"foo", "bar"}}), nlohmann::json::parse(resp["content"].value("body", "")));
+    }
+
+
+    TEST(EpollRESTClient, Send_SharedBody)
+    {
+        const unsigned   ITER_COUNT = 16;
+        std::atomic_uint passTest {0};
+        std::atomic_uint completed {0};
+
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // One large immutable body fanned out to every request; the head and body are gathered by sendmsg()
+        auto body = std::make_shared<const std::string>(256 * 1024, 'x');
+
+        basic_callbacktype valid = [&](const auto&, const auto& resp) {
+            if (resp.success() && resp["content"].value("body", "") == *body) passTest++;
+            completed++;
+            completed.notify_all();
+        };
+
+        for (unsigned i = 0; i < ITER_COUNT; i++) {
+            ReqPost req {SplitUri(server.url("/shared"))};
+            req.setContent("text/plain", body);
+            erc.send(std::move(req), valid);
+        }
+
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, passTest.load());
+    }
+
+
+    TEST(EpollRESTClient, Chunked_And_Close)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto r1    = ReqGet {SplitUri(server.url("/chunked"))};
+        auto resp1 = erc.send(r1);
+        ASSERT_TRUE(resp1.success());
+        EXPECT_EQ("/chunked", resp1["content"].value("path", ""));
+
+        auto r2    = ReqGet {SplitUri(server.url("/close"))};
+        auto resp2 = erc.send(r2);
+        ASSERT_TRUE(resp2.success());
+        EXPECT_EQ("/close", resp2["content"].value("path", ""));
+
+        auto r3    = ReqHead {SplitUri(server.url("/head"))};
+        auto resp3 = erc.send(r3);
+        EXPECT_TRUE(resp3.success());
+    }
+
+
+    TEST(EpollRESTClient, Stream_Content)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // Fed to the handler across both chunks; the response holds no content
+        auto collector = std::make_shared<json_pointer_collector>(
+                std::vector<nlohmann::json::json_pointer> {nlohmann::json::json_pointer("/path")});
+        auto r1 = ReqGet {SplitUri(server.url("/chunked"))};
+        r1.setContentHandler(collector);
+        auto resp1 = erc.send(r1);
+        ASSERT_TRUE(resp1.success());
+        EXPECT_EQ(nlohmann::json({{"path", "/chunked"}}), collector->result());
+        EXPECT_TRUE(resp1["content"].is_null());
+
+        // Content-Length delimited; the connection remains usable after the handler stopped the parse
+        auto all = std::make_shared<json_pointer_collector>(std::vector<nlohmann::json::json_pointer> {nlohmann::json::json_pointer("")});
+        auto r2  = ReqGet {SplitUri(server.url("/whole"))};
+        r2.setContentHandler(all);
+        auto resp2 = erc.send(r2);
+        ASSERT_TRUE(resp2.success());
+        EXPECT_EQ("/whole", all->result().value("path", ""));
+
+        auto r3    = ReqGet {SplitUri(server.url("/after"))};
+        auto resp3 = erc.send(r3);
+        ASSERT_TRUE(resp3.success());
+        EXPECT_EQ("/after", resp3["content"].value("path", ""));
+        EXPECT_EQ(1, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Projection)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto req = ReqGet {SplitUri(server.url("/chunked"))};
+        req.project({"/method"});
+        auto resp = erc.send(req);
+        ASSERT_TRUE(resp.success());
+        EXPECT_EQ(nlohmann::json({{"method", "GET"}}), resp["content"]);
+    }
+
+
+    struct echo_doc
+    {
+        std::string method {};
+        std::string path {};
+        std::string body {};
+        RESTCL_DEFINE_TYPE_INTRUSIVE(echo_doc, method, path, body)
+    };
+
+
+    TEST(EpollRESTClient, Send_Typed)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // Struct to wire and wire to struct
+        auto req = ReqPost {SplitUri(server.url("/typed"))};
+        req.setContent(echo_doc {.method = "m", .path = "p", .body = "b"});
+        auto r = erc.send<echo_doc>(req);
+        ASSERT_TRUE(r.response.success());
+        ASSERT_TRUE(r.content.has_value());
+        EXPECT_EQ("POST", r.content->method);
+        EXPECT_EQ("/typed", r.content->path);
+        EXPECT_EQ(nlohmann::json({{"method", "m"}, {"path", "p"}, {"body", "b"}}), nlohmann::json::parse(r.content->body));
+        EXPECT_TRUE(r.response["content"].is_null());
+
+        // Not a match for the struct
+        auto bad = erc.send<std::vector<int>>(req);
+        EXPECT_FALSE(bad.content.has_value());
+        EXPECT_FALSE(bad.error.empty());
+
+        std::binary_semaphore done {0};
+        std::string           path {};
+        erc.send<echo_doc>(ReqGet {SplitUri(server.url("/typed/async"))},
+                           [&](const basic_request&, const basic_response& resp, const std::optional<echo_doc>& doc) {
+                               if (resp.success() && doc) path = doc->path;
+                               done.release();
+                           });
+        ASSERT_TRUE(done.try_acquire_for(std::chrono::seconds(5)));
+        EXPECT_EQ("/typed/async", path);
+    }
+
+
+    TEST(EpollRESTClient, Send_Move)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // The callback takes ownership of the request and the response
+        std::vector<std::pair<basic_request, basic_response>> kept;
+        std::mutex                                            keptLock;
+        std::counting_semaphore<4>                            done {0};
+        for (int i = 0; i < 2; i++) {
+            erc.send(ReqGet {SplitUri(server.url(std::format("/move/{}", i)))}, [&](basic_request&& req, basic_response&& resp) {
+                std::scoped_lock<std::mutex> l(keptLock);
+                kept.emplace_back(std::move(req), std::move(resp));
+                done.release();
+            });
+        }
+
+        // Or only the response
+        std::optional<basic_response> last;
+        erc.send(ReqGet {SplitUri(server.url("/move/response"))}, [&](basic_response&& resp) {
+            last.emplace(std::move(resp));
+            done.release();
+        });
+
+        for (int i = 0; i < 3; i++) ASSERT_TRUE(done.try_acquire_for(std::chrono::seconds(5)));
+        ASSERT_EQ(2, kept.size());
+        for (auto& [req, resp] : kept) {
+            ASSERT_TRUE(resp.success());
+            EXPECT_EQ(req.uri.urlPart, resp["content"].value("path", ""));
+        }
+        ASSERT_TRUE(last.has_value());
+        EXPECT_EQ("/move/response", (*last)["content"].value("path", ""));
+
+        // The pooled request slot is emptied; nothing of an earlier request reaches the moved-from request of another caller
+        erc.send(ReqGet {SplitUri(server.url("/secret")), {{"Authorization", "Bearer secret"}}}, [&](basic_response&&) { done.release(); });
+        ASSERT_TRUE(done.try_acquire_for(std::chrono::seconds(5)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto next = ReqGet {SplitUri(server.url("/next"))};
+        erc.send(std::move(next), [&](basic_response&&) { done.release(); });
+        ASSERT_TRUE(done.try_acquire_for(std::chrono::seconds(5)));
+        EXPECT_FALSE(next.headers().contains("Authorization"));
+        EXPECT_NE("/secret", next.uri.urlPart);
+    }
+
+
+    TEST(EpollRESTClient, Send_Async_NoAllocation)
+    {
+        const int BATCH = 32;
+
+        loopback_server server;
+        // Every connection of a round is kept so the next round does not connect
+        EpollRESTClient erc("restcl-test", {.maxIdlePerOrigin = 2 * BATCH});
+        // The User-Agent is part of the shared headers so that the send does not add it to the request
+        request_prototype<RESTMethodType::Get> items {SplitUri(server.url("/items")), {{"User-Agent", erc.UserAgent}}};
+
+        std::atomic_int  completed {0};
+        std::atomic_int  passed {0};
+        std::atomic_bool submitted {false};
+        auto             round = [&](int count, bool counted) {
+            std::vector<rest_request<RESTMethodType::Get>> reqs;
+            reqs.reserve(count);
+            for (int i = 0; i < count; i++) reqs.push_back(items.make(std::format("/items/{}", i)));
+            completed = 0;
+            submitted = false;
+
+            // Counts the submitting thread, the executor and the event loop until every completion has run
+            allocationCount  = 0;
+            countAllocations = counted;
+
+            // No transaction is recycled until every request of the round holds one; the warm round thus leaves enough
+            // transactions in the pool regardless of how quickly the event loop completes them
+            for (auto& req : reqs) {
+                erc.send(std::move(req), [&](basic_response&& resp) {
+                    submitted.wait(false);
+                    if (resp.success()) passed++;
+                    completed++;
+                    completed.notify_all();
+                });
+            }
+            submitted = true;
+            submitted.notify_all();
+
+            for (auto c = completed.load(); c < count; c = completed.load()) completed.wait(c);
+            countAllocations = false;
+            return allocationCount.load();
+        };
+
+        // Warm the pool of transactions and the connections
+        round(2 * BATCH, false);
+        EXPECT_EQ(0, round(BATCH, true));
+        EXPECT_EQ(3 * BATCH, passed.load());
+    }
+
+
+    TEST(EpollRESTClient, KeepAlive)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        for (auto i = 0; i < 10; i++) {
+            auto req = ReqGet {SplitUri(server.url(std::format("/ka/{}", i)))};
+            EXPECT_TRUE(erc.send(req).success());
+        }
+
+        // Sequential requests to the same origin share one connection
+        EXPECT_EQ(1, server.accepted.load());
+        EXPECT_EQ(10, server.served.load());
+    }
+
+
+    TEST(EpollRESTClient, KeepAlive_Stale)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto warm = ReqGet {SplitUri(server.url("/warm"))};
+        EXPECT_TRUE(erc.send(warm).success());
+
+        // An idempotent request on the reused connection is resent once on a fresh connection
+        auto get  = ReqGet {SplitUri(server.url("/drop"))};
+        auto resp = erc.send(get);
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + ECONNRESET, resp.status().code);
+        EXPECT_EQ(3, server.served.load());
+        EXPECT_EQ(2, server.accepted.load());
+
+        EXPECT_TRUE(erc.send(warm).success());
+
+        // A POST may have been applied; it is left to the caller
+        auto post = ReqPost {SplitUri(server.url("/drop"))};
+        resp      = erc.send(post);
+        EXPECT_EQ(static_cast<int>(restcl_status::Retryable), resp.status().code);
+        EXPECT_EQ(5, server.served.load());
+        EXPECT_EQ(3, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Send_Async_Many)
+    {
+        const unsigned   ITER_COUNT = 200;
+        std::atomic_uint passTest {0};
+        std::atomic_uint completed {0};
+
+        loopback_server server;
+        EpollRESTClient erc;
+
+        basic_callbacktype valid = [&](const auto& req, const auto& resp) {
+            if (resp.success() && resp["content"].value("path", "") == req.uri.urlPart) passTest++;
+            completed++;
+            completed.notify_all();
+        };
+
+        for (unsigned i = 0; i < ITER_COUNT; i++) {
+            erc.send(ReqGet {SplitUri(server.url(std::format("/async/{}", i)))}, valid);
+        }
+
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, passTest.load());
+    }
+
+
+    TEST(EpollRESTClient, PerOriginLimit)
+    {
+        const unsigned   ITER_COUNT = 500;
+        std::atomic_uint passTest {0};
+        std::atomic_uint completed {0};
+
+        loopback_server server;
+        EpollRESTClient erc("restcl-test", {.maxIdlePerOrigin = 4, .maxPerOrigin = 4});
+
+        for (unsigned i = 0; i < ITER_COUNT; i++) {
+            erc.send(ReqGet {SplitUri(server.url(std::format("/limit/{}", i)))}, [&](const auto&, const auto& resp) {
+                if (resp.success()) passTest++;
+                completed++;
+                completed.notify_all();
+            });
+        }
+
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, passTest.load());
+        // Requests beyond the limit waited for a pooled connection instead of opening their own
+        EXPECT_LE(server.accepted.load(), 4);
+    }
+
+
+    TEST(EpollRESTClient, Fails_Refused)
+    {
+        EpollRESTClient erc;
+
+        // Nobody listens on the port after the server has gone
+        std::string endpoint;
+        {
+            loopback_server server;
+            endpoint = server.url("/");
+        }
+
+        auto req  = ReqGet {SplitUri(endpoint)};
+        auto resp = erc.send(req);
+        EXPECT_FALSE(resp.success());
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + ECONNREFUSED, resp.status().code);
+    }
+
+
+    TEST(EpollRESTClient, Resolve)
+    {
+        const unsigned   ITER_COUNT = 20;
+        std::atomic_uint passTest {0};
+        std::atomic_uint completed {0};
+
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // The requests wait for a single lookup of the host by the resolver thread
+        for (unsigned i = 0; i < ITER_COUNT; i++) {
+            erc.send(ReqGet {SplitUri(std::format("http://localhost:{}/resolve/{}", server.port, i))},
+                     [&](const auto&, const auto& resp) {
+                         if (resp.success()) passTest++;
+                         completed++;
+                         completed.notify_all();
+                     });
+        }
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, passTest.load());
+
+        auto req  = ReqGet {SplitUri(std::string("http://restcl-test.invalid/"))};
+        auto resp = erc.send(req);
+        EXPECT_FALSE(resp.success());
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + EHOSTUNREACH, resp.status().code);
+    }
+
+
+    TEST(EpollRESTClient, Deadline_Expired)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        // The deadline passed before the request was sent; the server is never contacted
+        auto req = ReqGet {SplitUri(server.url("/late"))};
+        req.setDeadline(std::chrono::steady_clock::now() - std::chrono::milliseconds(1));
+        auto resp = erc.send(req);
+        EXPECT_EQ(static_cast<int>(restcl_status::Timeout), resp.status().code);
+        EXPECT_EQ(0, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Deadline_InFlight)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+        erc.DeadlineHeader = "Request-Timeout";
+
+        auto req = ReqGet {SplitUri(server.url("/stall"))};
+        req.setTimeout(std::chrono::milliseconds(100));
+        auto start = std::chrono::steady_clock::now();
+        auto resp  = erc.send(req);
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + ETIMEDOUT, resp.status().code);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+        // The server was told of the budget
+        auto budget = std::stoi(std::string {req.headers().value("Request-Timeout", "0")});
+        EXPECT_GT(budget, 0);
+        EXPECT_LE(budget, 100);
+
+        // The timed out connection was closed; the next request opens a new one
+        auto again = ReqGet {SplitUri(server.url("/again"))};
+        EXPECT_TRUE(erc.send(again).success());
+        EXPECT_EQ(2, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Timeouts_Phases)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        auto elapsed = [](auto start) { return std::chrono::steady_clock::now() - start; };
+
+        // No response within the time to first byte
+        auto stall = ReqGet {SplitUri(server.url("/stall"))};
+        stall.setTimeouts({.firstByte = std::chrono::milliseconds(50)});
+        auto start = std::chrono::steady_clock::now();
+        auto resp  = erc.send(stall);
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + ETIMEDOUT, resp.status().code);
+        EXPECT_GE(elapsed(start), std::chrono::milliseconds(50));
+        EXPECT_LT(elapsed(start), std::chrono::seconds(1));
+
+        // The response begins in time but does not finish within the total
+        auto trickle = ReqGet {SplitUri(server.url("/trickle"))};
+        trickle.setTimeouts({.firstByte = std::chrono::milliseconds(50), .total = std::chrono::milliseconds(150)});
+        start = std::chrono::steady_clock::now();
+        resp  = erc.send(trickle);
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + ETIMEDOUT, resp.status().code);
+        EXPECT_GE(elapsed(start), std::chrono::milliseconds(150));
+        EXPECT_LT(elapsed(start), std::chrono::seconds(1));
+
+        // Each timed out connection was closed
+        auto ok = ReqGet {SplitUri(server.url("/ok"))};
+        ok.setTimeouts({.connect = std::chrono::seconds(1), .firstByte = std::chrono::seconds(1), .total = std::chrono::seconds(2)});
+        EXPECT_TRUE(erc.send(ok).success());
+        EXPECT_EQ(3, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Timeouts_Many)
+    {
+        const unsigned   ITER_COUNT = 200;
+        std::atomic_uint timedOut {0};
+        std::atomic_uint completed {0};
+
+        loopback_server server;
+        EpollRESTClient erc("restcl-test", {.maxPerOrigin = 50});
+
+        // More than the per-origin limit: the waiting requests start as the timed out connections close
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned i = 0; i < ITER_COUNT; i++) {
+            auto req = ReqGet {SplitUri(server.url("/stall"))};
+            req.setTimeouts({.firstByte = std::chrono::milliseconds(20 + i % 40)});
+            erc.send(std::move(req), [&](const auto&, const auto& resp) {
+                if (resp.status().code == EpollRESTClient::ERRNO_BASE + ETIMEDOUT) timedOut++;
+                completed++;
+                completed.notify_all();
+            });
+        }
+
+        for (auto c = completed.load(); c < ITER_COUNT; c = completed.load()) completed.wait(c);
+        EXPECT_EQ(ITER_COUNT, timedOut.load());
+        // Four waves of at most 60ms
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    }
+
+
+    TEST(EpollRESTClient, Cancel)
+    {
+        loopback_server server;
+        EpollRESTClient erc("restcl-test", {.maxPerOrigin = 2});
+
+        std::mutex                 lock;
+        std::map<std::string, int> results;
+        std::atomic_uint           completed {0};
+        auto                       record = [&](basic_request&& req, basic_response&& resp) {
+            {
+                std::scoped_lock<std::mutex> l(lock);
+                results[req.uri.urlPart] = resp.status().code;
+            }
+            completed++;
+            completed.notify_all();
+        };
+
+        // Fan out: the first response cuts the others short. Two stall on their connections and the third waits for one.
+        std::stop_source fanout;
+        auto             start = std::chrono::steady_clock::now();
+        erc.send(ReqGet {SplitUri(server.url("/stall"))}, fanout.get_token(), record);
+        erc.send(ReqGet {SplitUri(server.url("/stall/again"))}, fanout.get_token(), record);
+        erc.send(ReqGet {SplitUri(server.url("/waiting"))}, fanout.get_token(), record);
+        while (server.accepted.load() < 2) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        EXPECT_EQ(0, completed.load());
+        fanout.request_stop();
+
+        for (auto c = completed.load(); c < 3; c = completed.load()) completed.wait(c);
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), results["/stall"]);
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), results["/stall/again"]);
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), results["/waiting"]);
+
+        // Stopped before the send; the server is not contacted
+        auto early = ReqGet {SplitUri(server.url("/early"))};
+        early.setStopToken(fanout.get_token());
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), erc.send(early).status().code);
+        EXPECT_EQ(2, server.accepted.load());
+
+        // The cancelled connections were closed; a token which is never stopped does not get in the way
+        std::stop_source unused;
+        for (int i = 0; i < 3; i++) {
+            auto req = ReqGet {SplitUri(server.url("/ok"))};
+            req.setStopToken(unused.get_token());
+            EXPECT_TRUE(erc.send(req).success());
+        }
+        EXPECT_EQ(3, server.accepted.load());
+    }
+
+
+    TEST(EpollRESTClient, Cancel_SameBatch)
+    {
+        loopback_server server;
+        EpollRESTClient erc;
+
+        std::stop_source      stop;
+        std::atomic_int       held {0};
+        std::binary_semaphore heldDone {0};
+        std::binary_semaphore blocking {0};
+        std::binary_semaphore unblock {0};
+        erc.send(ReqGet {SplitUri(server.url("/held"))}, stop.get_token(), [&](basic_request&&, basic_response&& resp) {
+            held = resp.status().code;
+            heldDone.release();
+        });
+        while (server.held.load() < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+        // Another callback blocks the loop while the cancellation is queued and the response of the held request arrives;
+        // both are then reported by the same epoll_wait()
+        erc.send(ReqGet {SplitUri(server.url("/blocking"))}, [&](basic_request&&, basic_response&&) {
+            blocking.release();
+            unblock.acquire();
+        });
+        ASSERT_TRUE(blocking.try_acquire_for(std::chrono::seconds(5)));
+        stop.request_stop();
+        server.releaseHeld();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        unblock.release();
+
+        ASSERT_TRUE(heldDone.try_acquire_for(std::chrono::seconds(5)));
+        EXPECT_EQ(static_cast<int>(restcl_status::Cancelled), held.load());
+        auto after = ReqGet {SplitUri(server.url("/after"))};
+        EXPECT_TRUE(erc.send(after).success());
+    }
+
+
+    TEST(EpollRESTClient, Shutdown)
+    {
+        loopback_server  server;
+        std::atomic_uint completed {0};
+        std::atomic_uint cancelled {0};
+        {
+            // One request stalls on the connection and the others wait for it
+            EpollRESTClient erc("restcl-test", {.maxPerOrigin = 1});
+            for (int i = 0; i < 8; i++) {
+                erc.send(ReqGet {SplitUri(server.url(std::format("/stall/{}", i)))}, [&](basic_response&& resp) {
+                    completed++;
+                    if (resp.status().code == EpollRESTClient::ERRNO_BASE + ECANCELED) cancelled++;
+                });
+            }
+            while (server.accepted.load() < 1) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // Destroying the client completes every request once
+        EXPECT_EQ(8, completed.load());
+        EXPECT_EQ(8, cancelled.load());
+    }
+
+
+    TEST(EpollRESTClient, Fails_Https)
+    {
+        EpollRESTClient erc;
+
+        auto req  = ReqGet {SplitUri(std::string {"https://127.0.0.1:1/"})};
+        auto resp = erc.send(req);
+        EXPECT_FALSE(resp.success());
+        EXPECT_EQ(EpollRESTClient::ERRNO_BASE + EPROTONOSUPPORT, resp.status().code);
+    }
+} // namespace siddiqsoft
+#endif